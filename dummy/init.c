@@ -10,39 +10,39 @@
 #include "main.h"
 #include "lcd/LCDManager.h"
 #include "lcd/LCDFunctions.h"
+#include "lcd/vexprintf.h"
 
 
-char * VulcanText()
+bool VulcanText(char *buffer, unsigned int size)
 {
-	return "VULCAN";
+	snprintf(buffer, size, "VULCAN");
+	return true;
 }
 
-static char * battext;
-char * BatteryText()
+bool BatteryText(char *buffer, unsigned int size)
 {
-	free(battext);
-	battext = (char*)malloc(16*sizeof(char));
-	snprintf(battext, 16, "M:%1.2fV", (double)powerLevelMain()/1000.0);
-	if (battext == NULL) return "";
-	return battext;
+	vex_snprintf(buffer, size, "M:%1.2qV", powerLevelMain(), 1000);
+	return true;
 }
 
-char * OSEText()
+bool OSEText(char *buffer, unsigned int size)
 {
-	return "OSE | 7701";
+	snprintf(buffer, size, "OSE | 7701");
+	return true;
 }
 
-char * ModeText()
+bool ModeText(char *buffer, unsigned int size)
 {
 	if (isEnabled())
 	{
 		if (isAutonomous())
-			return "Autonomous";
+			snprintf(buffer, size, "Autonomous");
 		else
-			return "Teleop";
+			snprintf(buffer, size, "Teleop");
 	}
 	else
-		return "Disabled";
+		snprintf(buffer, size, "Disabled");
+	return true;
 }
 
 void initializeIO() {
@@ -51,10 +51,10 @@ void initializeIO() {
 void initialize() {
 	lcdInitialize();
 	/*initLCDManager();
-	DisplayText text1 = { &VulcanText, Centered };
-	DisplayText text2 = { &BatteryText, Centered };
-	DisplayText text3 = { &OSEText, Centered };
-	DisplayText text4 = { &ModeText, Centered };
+	DisplayText text1 = { &VulcanText, Centered, 1000, 0 };
+	DisplayText text2 = { &BatteryText, Centered, 2000, 0 };
+	DisplayText text3 = { &OSEText, Centered, 1000, 0 };
+	DisplayText text4 = { &ModeText, Centered, 1000, 0 };
 	addCycleText(text1, 1);
 	addCycleText(text2, 1);
 	addCycleText(text3, 1);
@@ -1,87 +1,337 @@
 /**
- * @file libsml/recorder.c
+ * @file dummy/recorder.c
  *
  * @brief Records data about motor speeds, sensor data, etc. for analysis.
+ *
+ * @details recorderInit() logs the IMEs as fixed size binary records (RecorderRecord) to RECORDER_FILE. A sampling
+ *          task fills one half of a RAM double buffer on time while a low priority task writes the other, full half
+ *          to flash, so sampling at 100 Hz costs each period only the IME reads. The flash write still holds up most
+ *          tasks while it runs (see fopen() in API.h), so the halves are large to make writes rare. If the writer
+ *          falls a whole buffer behind, samples are dropped rather than delayed, which shows as a gap in the times.
+ *          <br>
+ *          The file starts with a header of RECORDER_HEADER_SIZE bytes. tools/telemetry2csv.c decodes it to CSV. <br>
+ *          recorderUser() logs the drive it picks as text lines through recorderLog(), which appends to a file kept
+ *          open for the whole run. PROS has no append mode, so a run writes new files, RECORDER_LOG_FILE followed by
+ *          a number, moving on to the next one every RECORDER_LOG_MAX_SIZE bytes and overwriting the oldest. The
+ *          number of the file written last is kept in RECORDER_LOG_INDEX_FILE, so a new boot carries on after it.
  */
 
 #include "main.h"
-//#include "stdlib.h" //necessary for file r/w; may already be included in main.h
-#include "sml/recorder.h"
+#include "dummy/recorder.h"
 #include "vulcan/mechop.h"
 #include "lcd/LCDFunctions.h"
+#include "lcd/vexprintf.h"
+#include <string.h>
 #include <math.h>
-#include <stdio.h>
 #include "vulcan/Chassis.h"
 
+static RecorderRecord Buffers[2][RECORDER_BUFFER_RECORDS];
+static volatile unsigned char Active; // Half being filled by the sampling task
+static volatile unsigned int Count; // Records in the active half
+static volatile bool Pending; // The other half is full and waiting for the writer
+static volatile bool Recording;
+static volatile unsigned long Dropped;
+static bool (*RecordMode)();
+static unsigned long Period;
+static FILE *Stream;
+static FILE *LogStream; // The log of recorderLog(), see recorderLogOpen()
+static Semaphore FullSignal;
+
+/**
+ * @brief Samples every IME each Period until RecordMode() is false, then has the writer finish the file
+ */
+static void recorderSampleTask(void *none)
+{
+	unsigned long begin = millis(), wakeTime = begin;
+	while (RecordMode())
+	{
+		if (Count == RECORDER_BUFFER_RECORDS && !Pending)
+		{
+			// Hand the full half to the writer and fill the other one
+			Active = !Active;
+			Count = 0;
+			Pending = true;
+			semaphoreGive(FullSignal);
+		}
+		if (Count < RECORDER_BUFFER_RECORDS)
+		{
+			RecorderRecord *record = &Buffers[Active][Count];
+			record->time = millis() - begin;
+			for (int i = 0; i < RECORDER_NUM_IMES; i++)
+			{
+				int count = 0, velocity = 0;
+				imeGet(i, &count);
+				imeGetVelocity(i, &velocity);
+				record->counts[i] = count;
+				record->velocities[i] = velocity;
+			}
+			Count++;
+		}
+		else
+			Dropped++;
+		taskDelayUntil(&wakeTime, Period);
+	}
+	Recording = false;
+	semaphoreGive(FullSignal);
+	taskDelete(NULL);
+}
+
+/**
+ * @brief Writes each full half to flash, then the rest and closes the file once sampling stops
+ */
+static void recorderWriteTask(void *none)
+{
+	while (true)
+	{
+		semaphoreTake(FullSignal, -1);
+		if (Pending)
+		{
+			fwrite(Buffers[!Active], sizeof(RecorderRecord), RECORDER_BUFFER_RECORDS, Stream);
+			Pending = false;
+		}
+		if (!Recording)
+			break;
+	}
+	fwrite(Buffers[Active], sizeof(RecorderRecord), Count, Stream);
+	fclose(Stream);
+	Stream = NULL;
+	taskDelete(NULL);
+}
 
 /**
- * @brief Initializes and begins recording of the run of the robot.
+ * @brief Initializes and begins recording of the run of the robot. Returns right away, the recording runs in its
+ *        own tasks until the mode ends.
  *
  * @param mode
  *        'a' for recording autonomous, 'e' for recording when robot is enabled.
  * @param time
- *        time in between recording intervals.
+ *        time in between recording intervals (10 for 100 Hz).
  *
  * @return 1 or 0, depends on failure or success of the program, respectively.
  */
 int recorderInit(char mode, const unsigned long time)
 {
-	fdelete("trial.csv"); //delete the previous file and start with fresh slate
-
-	FILE *data_stream = fopen("trial.csv", "w"); //points to file to "w"rite
-	bool (*record_mode)() = NULL; //initialize to NULL
+	if (Recording || Stream != NULL || LogStream != NULL)
+		return EXIT_FAILURE; // A recording or a log is still being written, only one file can be written at a time
 
 	if (mode == 'a')
-		record_mode = &isAutonomous;
+		RecordMode = &isAutonomous;
 	else if (mode == 'e')
-		record_mode = &isEnabled;
+		RecordMode = &isEnabled;
 	else
 	{
 		lcdSetText(uart1, 1, "Recorder Failed ");
 		lcdSetText(uart1, 2, "to Initialize!  ");
 		return EXIT_FAILURE; //constant in stdlib: equivalent to program failure (1)
 	}
-	
-	//variable necessary for recording and writing
-	unsigned long curr_time = 0;
-	int imeVelocity[10] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-	int imeCount[10] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-	int i = 0;
-	
-	fprintf( data_stream, "curr_time,imeCount[0],imeVelocity[0],imeCount[1],imeVelocity[1],imeCount[2],imeVelocity[2],imeCount[3],imeVelocity[3],imeCount[4],imeVelocity[4],imeCount[5],imeVelocity[5],imeCount[6],imeVelocity[6],imeCount[7],imeVelocity[7],imeCount[8],imeVelocity[8],imeCount[9],imeVelocity[9]\n");
 
-	while (*record_mode) //usage of pointers will retrieve the right input
+	fdelete(RECORDER_FILE); //delete the previous file and start with fresh slate
+	Stream = fopen(RECORDER_FILE, "w");
+	if (Stream == NULL)
+		return EXIT_FAILURE;
+	unsigned char header[RECORDER_HEADER_SIZE] = { 'T', 'L', RECORDER_VERSION, RECORDER_NUM_IMES, time & 0xFF,
+		(time >> 8) & 0xFF };
+	fwrite(header, 1, RECORDER_HEADER_SIZE, Stream);
+
+	if (FullSignal == NULL)
+		FullSignal = semaphoreCreate();
+	semaphoreTake(FullSignal, 0); // Starts taken, so the writer waits for the first give
+	Period = time;
+	Active = 0;
+	Count = 0;
+	Pending = false;
+	Dropped = 0;
+	Recording = true;
+	taskCreate(&recorderWriteTask, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_LOWEST + 1);
+	taskCreate(&recorderSampleTask, TASK_MINIMAL_STACK_SIZE * 2, NULL, TASK_PRIORITY_DEFAULT + 1);
+	return EXIT_SUCCESS; //program success (0)
+}
+
+/**
+ * @brief Returns whether a recording is sampling
+ */
+bool recorderIsRecording()
+{
+	return Recording;
+}
+
+/**
+ * @brief Returns how many samples the last recording dropped because the writer fell behind
+ */
+unsigned long recorderDropped()
+{
+	return Dropped;
+}
+
+/**
+ * @brief Copies the last recording as is to a stream, e.g. stdout to capture it on the PC for tools/telemetry2csv.c
+ *
+ * @return 1 or 0, depends on failure or success of the program, respectively.
+ */
+int recorderDump(FILE *stream)
+{
+	if (Stream != NULL)
+		return EXIT_FAILURE; // Still being written
+	FILE *file = fopen(RECORDER_FILE, "r");
+	if (file == NULL)
+		return EXIT_FAILURE;
+	unsigned char chunk[sizeof(RecorderRecord)];
+	size_t length;
+	while ((length = fread(chunk, 1, sizeof(chunk), file)) > 0)
+		fwrite(chunk, 1, length, stream);
+	fclose(file);
+	return EXIT_SUCCESS;
+}
+
+unsigned long start;
+
+static char LogBuffer[RECORDER_LOG_BUFFER_SIZE];
+static unsigned int LogLength; // Bytes waiting in LogBuffer
+static unsigned int LogWritten; // Bytes written to the current file
+static unsigned char LogIndex = RECORDER_LOG_FILES; // Number of the current file, RECORDER_LOG_FILES until read from flash
+static Mutex LogMutex;
+
+/**
+ * @brief Opens the log file after the current one, deleting what it held. The number of the file is saved to
+ *        RECORDER_LOG_INDEX_FILE first, as only one file can be open for writing, so the next boot carries on after it.
+ *
+ * @return The file, or NULL if it could not be opened
+ */
+static FILE *recorderLogNext()
+{
+	char name[sizeof(RECORDER_LOG_FILE) + 3];
+	FILE *file;
+	if (LogIndex >= RECORDER_LOG_FILES)
 	{
-		for (i = 0; i < 10; i++)
+		LogIndex = 0;
+		file = fopen(RECORDER_LOG_INDEX_FILE, "r");
+		if (file != NULL)
 		{
-			imeGetVelocity( i, &imeVelocity[i]);
-			imeGet( i, &imeCount[i]);
+			int last = fgetc(file);
+			if (last >= 0 && last < RECORDER_LOG_FILES)
+				LogIndex = last;
+			fclose(file);
 		}
-		fprintf( data_stream, "%lu,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n",curr_time,imeCount[0],imeVelocity[0],imeCount[1],imeVelocity[1],imeCount[2],imeVelocity[2],imeCount[3],imeVelocity[3],imeCount[4],imeVelocity[4],imeCount[5],imeVelocity[5],imeCount[6],imeVelocity[6],imeCount[7],imeVelocity[7],imeCount[8],imeVelocity[8],imeCount[9],imeVelocity[9]);
-		delay(time);
-		curr_time += time;
 	}
-	fclose( data_stream);
-	return EXIT_SUCCESS; //program success (0)
+	LogIndex = (LogIndex + 1) % RECORDER_LOG_FILES;
+
+	fdelete(RECORDER_LOG_INDEX_FILE);
+	file = fopen(RECORDER_LOG_INDEX_FILE, "w");
+	if (file != NULL)
+	{
+		fputc(LogIndex, file);
+		fclose(file);
+	}
+
+	snprintf(name, sizeof(name), "%s%d", RECORDER_LOG_FILE, LogIndex);
+	fdelete(name);
+	return fopen(name, "w");
+}
+
+/**
+ * @brief Writes LogBuffer to the current file, moving on to the next file first if the current one would pass
+ *        RECORDER_LOG_MAX_SIZE. Call with LogMutex taken.
+ */
+static void recorderLogWrite()
+{
+	if (LogStream == NULL || LogLength == 0)
+		return;
+	if (LogWritten > 0 && LogWritten + LogLength > RECORDER_LOG_MAX_SIZE)
+	{
+		// Rotate: the oldest file is overwritten, so the last RECORDER_LOG_FILES - 1 full files are kept
+		fclose(LogStream);
+		LogStream = recorderLogNext();
+		LogWritten = 0;
+		if (LogStream == NULL)
+			return;
+	}
+	fwrite(LogBuffer, 1, LogLength, LogStream);
+	LogWritten += LogLength;
+	LogLength = 0;
+}
+
+/**
+ * @brief Writes what is buffered and closes the log
+ */
+void recorderLogClose()
+{
+	if (LogMutex == NULL)
+		return;
+	mutexTake(LogMutex, -1);
+	recorderLogWrite();
+	if (LogStream != NULL)
+		fclose(LogStream);
+	LogStream = NULL;
+	LogLength = 0;
+	mutexGive(LogMutex);
+}
+
+/**
+ * @brief Closes the log once the robot is disabled, as the task writing it is stopped without warning
+ */
+static void recorderLogDisableTask(void *none)
+{
+	while (isEnabled() && LogStream != NULL)
+		delay(20);
+	recorderLogClose();
+	taskDelete(NULL);
+}
+
+/**
+ * @brief Starts a new log in the file after the last one. Lines are added with recorderLog() and reach flash
+ *        RECORDER_LOG_BUFFER_SIZE bytes at a time. The log is closed when the robot is disabled.
+ *
+ * @return 1 or 0, depends on failure or success of the program, respectively.
+ */
+int recorderLogOpen()
+{
+	if (LogStream != NULL)
+		return EXIT_SUCCESS;
+	if (Stream != NULL)
+		return EXIT_FAILURE; // Only one file can be written at a time
+	if (LogMutex == NULL)
+		LogMutex = mutexCreate();
+
+	LogStream = recorderLogNext();
+	if (LogStream == NULL)
+		return EXIT_FAILURE;
+	LogLength = 0;
+	LogWritten = 0;
+	start = millis();
+	taskCreate(&recorderLogDisableTask, TASK_MINIMAL_STACK_SIZE, NULL, TASK_PRIORITY_LOWEST + 1);
+	return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Adds a line to the log, formatted like lcdprintf(). Constant time, except for the write of a full buffer.
+ *        Lines longer than RECORDER_LOG_LINE_SIZE are cut.
+ */
+void recorderLog(const char *format, ...)
+{
+	if (LogStream == NULL)
+		return;
+	char line[RECORDER_LOG_LINE_SIZE];
+	va_list args;
+	va_start(args, format);
+	int length = vex_vsnprintf(line, RECORDER_LOG_LINE_SIZE, format, args);
+	va_end(args);
+
+	mutexTake(LogMutex, -1);
+	if (LogLength + length > RECORDER_LOG_BUFFER_SIZE)
+		recorderLogWrite();
+	if (LogLength + length <= RECORDER_LOG_BUFFER_SIZE) // Unless the next file could not be opened
+	{
+		memcpy(LogBuffer + LogLength, line, length);
+		LogLength += length;
+	}
+	mutexGive(LogMutex);
 }
 
-//unsigned long start;
 #define CURRENT_T    millis() - start
 #define MOTOROPTION  false // used for the function below
-#define BUFFER_SIZE  200
-static char buffer[BUFFER_SIZE]; //should be large enough
 int recorderUser(int l3, int l4, int r1, int r2)
 {
-    rename("data.cvs", "previous"); //rename data.cvs and label it as previous
-    FILE *previous_data = fopen("previous", "r"); //open previous data
-    FILE *trial_cvs = fopen("data.cvs", "w"); //creat new data.cvs
-    if (previous_data != NULL) {
-        lcdprintf(Left, 1, "Copying!!!");
-        while (fgets( buffer, BUFFER_SIZE, previous_data) != NULL) {
-            fprintf(trial_cvs, "%s\n", buffer); //copy everything
-        }
-        lcdprintf(Left, 1, "Done Copying");
-    }
+	recorderLogOpen(); // Once per run, every call after that appends to the open log
 
 	int left = thetaSector(getJoyTheta(l4, l3)), //left joystick
 		right = thetaSector(getJoyTheta(r1, r2)); // right joystick
@@ -91,7 +341,7 @@ int recorderUser(int l3, int l4, int r1, int r2)
 	if (abs(l3) < THRESHOLD && abs(l4) < THRESHOLD && abs(r1) < THRESHOLD && abs(r2) < THRESHOLD)
 	{
 		ChassisSet(0, 0, MOTOROPTION);
-		fprintf(trial_cvs, "0,0,%lu,Threshold\n", CURRENT_T);
+		recorderLog("0,0,%lu,Threshold\n", CURRENT_T);
 		return EXIT_FAILURE;
 	}
 
@@ -100,7 +350,7 @@ int recorderUser(int l3, int l4, int r1, int r2)
 		(abs(right) == 3 || abs(right) == 4))
 	{
 		ChassisSet(l3, r2, MOTOROPTION);
-		fprintf(trial_cvs, "%d,%d,%lu,Up-Down\n", l3, r2, CURRENT_T);
+		recorderLog("%d,%d,%lu,Up-Down\n", l3, r2, CURRENT_T);
 		lcdprint(Centered, 1, "tank");
 	}
 	//Left / Right
@@ -111,7 +361,7 @@ int recorderUser(int l3, int l4, int r1, int r2)
 		ChassisSetMecanum(M_PI_2,
 			p,
 			0, MOTOROPTION);
-		fprintf(trial_cvs, "M_PI_2,%d,0,%lu,Right\n", p, CURRENT_T);
+		recorderLog("M_PI_2,%d,0,%lu,Right\n", p, CURRENT_T);
 		lcdprint(Centered, 1, "strafe right");
 	}
 	else if ((abs(left)  == 7) &&
@@ -121,7 +371,7 @@ int recorderUser(int l3, int l4, int r1, int r2)
 		ChassisSetMecanum(-M_PI_2,
 			p,
 			0, MOTOROPTION);
-		fprintf(trial_cvs, "-M_PI_2,%d,0,%lu,Left\n", p, CURRENT_T);
+		recorderLog("-M_PI_2,%d,0,%lu,Left\n", p, CURRENT_T);
 		lcdprint(Centered, 1, "strafe left");
 	}
 
@@ -134,7 +384,7 @@ int recorderUser(int l3, int l4, int r1, int r2)
 		ChassisSetMecanum(M_PI_4,
 			h,
 			0, MOTOROPTION);
-		fprintf(trial_cvs, "M_PI_4,%d,0,%lu,Northeast\n", h, CURRENT_T);
+		recorderLog("M_PI_4,%d,0,%lu,Northeast\n", h, CURRENT_T);
 		lcdprintf(Centered, 1, "northeast%d", h);
 	}
 	else if ((left  == 5 || left  == 6) &&
@@ -144,7 +394,7 @@ int recorderUser(int l3, int l4, int r1, int r2)
 		ChassisSetMecanum(-M_PI_4,
 			p,
 			0, MOTOROPTION);
-		fprintf(trial_cvs, "-M_PI_4,%d,0,%lu,Northwest\n", p, CURRENT_T);
+		recorderLog("-M_PI_4,%d,0,%lu,Northwest\n", p, CURRENT_T);
 		lcdprint(Centered, 1, "northwest");
 	}
 
@@ -157,7 +407,7 @@ int recorderUser(int l3, int l4, int r1, int r2)
 		ChassisSetMecanum(-3.0 * M_PI_4,
 			p,
 			0, MOTOROPTION);
-		fprintf(trial_cvs, "-3.0*M_PI_4,%d,0,%lu,Southeast\n", p, CURRENT_T);
+		recorderLog("-3.0*M_PI_4,%d,0,%lu,Southeast\n", p, CURRENT_T);
 		lcdprint(Centered, 1, "southeast");
 	}
 	else if ((left  == -5 || left  == -6) &&
@@ -167,7 +417,7 @@ int recorderUser(int l3, int l4, int r1, int r2)
 		ChassisSetMecanum(3.0 * M_PI_4,
 			p,
 			0, MOTOROPTION);
-		fprintf(trial_cvs, "3.0*M_PI_4,%d,0,%lu,Southwest\n", p, CURRENT_T);
+		recorderLog("3.0*M_PI_4,%d,0,%lu,Southwest\n", p, CURRENT_T);
 		lcdprint(Centered, 1, "southwest");
 	}
 
@@ -199,10 +449,9 @@ int recorderUser(int l3, int l4, int r1, int r2)
 	else
 	{
 		ChassisSet(l3, r2, MOTOROPTION);
-		fprintf(trial_cvs, "%d,%d,%lu,Default:Tank\n", l3, r2, CURRENT_T);
+		recorderLog("%d,%d,%lu,Default:Tank\n", l3, r2, CURRENT_T);
 		lcdprint(Centered, 1, "default: tank");
 	}
 
-	fclose(trial_cvs); //for safety
 	return EXIT_SUCCESS;
 }
\ No newline at end of file
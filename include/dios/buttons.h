@@ -44,11 +44,37 @@ typedef enum
 	LCD_RIGHT = 26
 } buttons;
 
+/**
+* The bit of a button in the masks returned by buttonsGetMask(), buttonsGetPressed(), and buttonsGetReleased()
+*/
+#define BUTTON_MASK(button)		(1UL << (button))
+
+/**
+* The edges of a button a callback can be subscribed to
+*/
+typedef enum
+{
+	ButtonPress,
+	ButtonRelease
+} ButtonEdge;
+
 void initButtons();
+unsigned long buttonsRead();
+
+/**
+* Samples all buttons once per tick, call before checking for presses
+*/
+void buttonsSample();
 
 /**
 * Returns true if button press is newly detected, false if not
 */
 bool buttonIsNewPress(buttons);
+bool buttonIsNewRelease(buttons);
+bool buttonIsDown(buttons);
+unsigned long buttonsGetMask();
+unsigned long buttonsGetPressed();
+unsigned long buttonsGetReleased();
+bool buttonSubscribe(buttons, ButtonEdge, void (*)(buttons));
 
 #endif 
\ No newline at end of file
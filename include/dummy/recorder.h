@@ -1,13 +1,61 @@
 /**
- * @file include/sml/recorder.h
+ * @file include/dummy/recorder.h
  * @brief Header file for recording capabilities <br>
- * See libsml/recorder.c for details of all functions
+ * See dummy/recorder.c for details of all functions
+ * @sa tools/telemetry2csv.c @link tools/telemetry2csv.c
  *
  * @copyright Copyright(c) 2014-2015 Olympic Steel Eagles.All rights reserved. <br>
  * Portions of this file may contain elements from the PROS API. <br>
  * See include/main.h for additional notice.
  ********************************************************************************/
 
+#ifndef RECORDER_H_
+#define RECORDER_H_
+
+#include <stdint.h>
+
+#include "main.h"
+
+#define RECORDER_FILE				"trial"
+#define RECORDER_VERSION			1
+#define RECORDER_NUM_IMES			10
+#define RECORDER_BUFFER_RECORDS		32 // Records in each half of the double buffer, written to flash in one go
+#define RECORDER_LOG_FILE			"data" // Followed by the number of the file, see RECORDER_LOG_FILES
+#define RECORDER_LOG_FILES			4
+#define RECORDER_LOG_INDEX_FILE		"logindex" // One byte, the number of the log file written last, kept across boots
+#define RECORDER_LOG_MAX_SIZE		8192 // Bytes in a log file before the log moves on to the next one
+#define RECORDER_LOG_BUFFER_SIZE	512 // Bytes of log lines kept in RAM between writes to flash
+#define RECORDER_LOG_LINE_SIZE		64
+#define RECORDER_HEADER_SIZE		6 // 'T' 'L' version, RECORDER_NUM_IMES, then the period in milliseconds (2 bytes, little endian)
+
+/**
+ * @brief One sample of the telemetry file, written as is (little endian, no padding)
+ */
+typedef struct
+{
+	/**
+	 * @brief Milliseconds since the recording started
+	 */
+	uint32_t time;
+	/**
+	 * @brief imeGet() of each IME, 0 if missing
+	 */
+	int32_t counts[RECORDER_NUM_IMES];
+	/**
+	 * @brief imeGetVelocity() of each IME, 0 if missing
+	 */
+	int16_t velocities[RECORDER_NUM_IMES];
+} RecorderRecord;
+
+///@cond
 int recorderInit(char mode, const unsigned long time);
+bool recorderIsRecording();
+unsigned long recorderDropped();
+int recorderDump(FILE *);
+int recorderLogOpen();
+void recorderLog(const char *, ...);
+void recorderLogClose();
 extern unsigned long start;
-int recorderUser(int l3, int l4, int r1, int r2);
\ No newline at end of file
+int recorderUser(int l3, int l4, int r1, int r2);
+///@endcond
+#endif
@@ -13,6 +13,7 @@
 #define LCDFUNC_H_
 
 #include "main.h"
+#include "lcd/lcdformat.h"
 
 typedef enum
 {
@@ -20,11 +21,38 @@ typedef enum
 	Right,
 	Centered
 } textJustifications;
+
+/**
+ * @struct LCDStats
+ * Counts of LCD line updates which were sent over uart1 or suppressed because they were identical or coalesced
+ */
+typedef struct
+{
+	/**
+	 * @brief Bytes sent to the LCD
+	 */
+	unsigned long bytesSent;
+	/**
+	 * @brief Bytes that would have been sent without change detection and coalescing
+	 */
+	unsigned long bytesSuppressed;
+	/**
+	 * @brief Line updates sent to the LCD
+	 */
+	unsigned long linesSent;
+	/**
+	 * @brief Line updates skipped because nothing changed or a newer update replaced them
+	 */
+	unsigned long linesSuppressed;
+} LCDStats;
 ///@cond
 void lcdInitialize();
+LCDStats lcdGetStats();
+void lcdSetMarquee(unsigned long, unsigned long);
 bool lcdprint(textJustifications, unsigned char, char *);
 bool lcdprintv(textJustifications, unsigned char, char *, va_list);
 bool lcdprintf(textJustifications, unsigned char, char *, ...);
+bool lcdprintc(textJustifications, unsigned char, const LCDFormat *, ...);
 bool lcdprint_d(textJustifications, unsigned char, unsigned long, char *);
 bool lcdprint_dv(textJustifications, unsigned char, unsigned long, char *, va_list);
 bool lcdprint_df(textJustifications, unsigned char, unsigned long, char *, ...);
@@ -14,15 +14,34 @@
 
 #include "lcd/LCDFunctions.h"
 
+#define LCD_MANAGER_TEXT_SIZE	17 // Size of the buffer given to page providers, 16 characters and terminator
+
+/**
+ * @struct DisplayText
+ * A page cycled by the LCD Manager
+ */
 typedef struct
 {
-	char * (*GetText)(void);
-
+	/**
+	 * @brief Writes the text of the page into buffer (at most size characters including the terminator)
+	 *
+	 * @returns Returns false if the page should not be shown right now
+	 */
+	bool (*GetText)(char *buffer, unsigned int size);
 	textJustifications justification;
+	/**
+	 * @brief How long the page is shown before moving on to the next one, in milliseconds
+	 */
+	unsigned long dwell;
+	/**
+	 * @brief Pages are only cycled while no active page on the same line has a higher priority
+	 */
+	unsigned char priority;
 } DisplayText;
 ///@cond
 void initLCDManager();
-void addCycleText(DisplayText, int);
+bool addCycleText(DisplayText, int);
 void replaceCycleText(DisplayText, int, int);
+void lcdManagerAlert(textJustifications, int, unsigned long, const char *);
 ///@endcond
 #endif
\ No newline at end of file
@@ -0,0 +1,80 @@
+/**
+ * @file include/lcd/lcdformat.h
+ * @sa liblcd/lcdformat.c @link liblcd/lcdformat.c
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#ifndef LCDFORMAT_H_
+#define LCDFORMAT_H_
+
+#include "main.h"
+
+#define LCD_FORMAT_MAX_LENGTH		32 // Longest template (literal text plus field widths)
+#define LCD_FORMAT_MAX_FIELDS		6
+
+#define LCD_FORMAT_PAD_ZERO			0x01 // %0...
+#define LCD_FORMAT_PAD_RIGHT		0x02 // %-...
+#define LCD_FORMAT_PLUS				0x04 // %+...
+
+/**
+ * @struct LCDFormatField
+ * One conversion of a compiled format. FOR INTERNAL USAGE ONLY
+ */
+typedef struct
+{
+	/**
+	 * @brief The conversion character: d, u, x, X, q, c, or s
+	 */
+	char type;
+	/**
+	 * @brief LCD_FORMAT_* flags
+	 */
+	unsigned char flags;
+	/**
+	 * @brief Minimum width of the field, 0 if none was given
+	 */
+	unsigned char width;
+	/**
+	 * @brief Number of fractional digits (q only)
+	 */
+	unsigned char decimals;
+	/**
+	 * @brief Position of the field's slot in the template. The text between two slots is literal.
+	 */
+	unsigned char offset;
+} LCDFormatField;
+
+/**
+ * @struct LCDFormat
+ * A format string compiled once by lcdformatCompile() into a template and a list of fields, so that rendering only
+ * converts the arguments. Conversions are the same as vex_sprintf() (d, u, x, X, q, c, s) with the 0, -, and + flags.
+ */
+typedef struct
+{
+	/**
+	 * @brief The literal text of the format with a slot of width spaces reserved for every field
+	 */
+	char template[LCD_FORMAT_MAX_LENGTH + 1];
+	/**
+	 * @brief Length of template
+	 */
+	unsigned char length;
+	LCDFormatField fields[LCD_FORMAT_MAX_FIELDS];
+	unsigned char numFields;
+	/**
+	 * @brief True if every field is a number with a width, so the output has the same layout as the template
+	 *        whenever each number fits its slot
+	 */
+	bool fixed;
+} LCDFormat;
+///@cond
+bool lcdformatCompile(LCDFormat *, const char *);
+int lcdformatRenderv(const LCDFormat *, char *, unsigned int, va_list);
+int lcdformatRender(const LCDFormat *, char *, unsigned int, ...);
+///@endcond
+#endif
@@ -0,0 +1,83 @@
+/**
+ * @file include/lcd/lcdtree.h
+ * @sa liblcd/lcdtree.c @link liblcd/lcdtree.c
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#ifndef LCDTREE_H_
+#define LCDTREE_H_
+
+#include "main.h"
+
+#define LCD_TREE_MAX_DEPTH		4
+#define LCD_TREE_DELTAT			50 // Button polling rate of the menu task
+#define LCD_TREE_TIMEOUT		30000 // The menu closes after this many milliseconds without a button press
+#define LCD_TREE_OPEN_HOLD		1000 // Holding the center button this long opens the root menu
+#define LCD_TREE_REPEAT_DELAY	500 // Holding left or right while editing repeats the step after this long...
+#define LCD_TREE_REPEAT_RATE	100 // ...and then this often
+
+/**
+ * @brief The kinds of items in a menu tree
+ */
+typedef enum
+{
+	LCDTreeSubmenu,	// Opens children
+	LCDTreeAction,	// Runs callback
+	LCDTreeInt,		// Edits an int between min and max by step
+	LCDTreeDecimal,	// Edits a double in units of 1/scale between min and max by step (all in units of 1/scale)
+	LCDTreeEnum,	// Edits an int between min and max, showing options[value - min]
+	LCDTreeBool		// Toggles a bool
+} LCDTreeType;
+
+/**
+ * @struct lcd_tree_item
+ * An item of a menu tree. Trees are built from static arrays of items, nothing is allocated.
+ */
+typedef struct lcd_tree_item
+{
+	/**
+	 * @brief Shown on line 1 while the item is selected
+	 */
+	const char *title;
+	LCDTreeType type;
+	/**
+	 * @brief LCDTreeSubmenu: the items of the submenu
+	 */
+	struct lcd_tree_item *children;
+	unsigned char numChildren;
+	/**
+	 * @brief LCDTreeAction: run when selected. Other leaves: run after every change to the value (may be NULL).
+	 *        Called from the menu task.
+	 */
+	void (*callback)(struct lcd_tree_item *);
+	/**
+	 * @brief The live variable edited by the item: an int for LCDTreeInt and LCDTreeEnum, a double for LCDTreeDecimal,
+	 *        a bool for LCDTreeBool
+	 */
+	void *value;
+	int min, max, step;
+	/**
+	 * @brief LCDTreeDecimal: the value is shown and edited in units of 1/scale, e.g. 100 for hundredths
+	 */
+	int scale;
+	/**
+	 * @brief LCDTreeDecimal: number of decimals shown
+	 */
+	unsigned char decimals;
+	/**
+	 * @brief LCDTreeEnum: max - min + 1 labels
+	 */
+	const char **options;
+} LCDTreeItem;
+///@cond
+void lcdtreeInitialize(LCDTreeItem *);
+void lcdtreeOpen(LCDTreeItem *);
+void lcdtreeClose();
+bool lcdtreeIsOpen();
+///@endcond
+#endif
@@ -62,6 +62,7 @@ int         vex_sprintf (char *out, const char *format, ...);
 int         vex_snprintf(char *out, uint16_t max_len, const char *format, ...);
 int         vex_vsprintf( char *out, const char *format, va_list args );
 int         vex_vsnprintf(char *out, uint16_t max_len, const char *format, va_list args );
+int         vex_fixsplit( int value, int divisor, unsigned dec_digits, unsigned long *wholeNum, unsigned long *decimalNum );
 
 #ifdef __cplusplus
 }
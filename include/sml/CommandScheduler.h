@@ -0,0 +1,105 @@
+/**
+ * @file include/sml/CommandScheduler.h
+ * @author Elliot Berman
+ * @sa libsml/CommandScheduler.c @link libsml/CommandScheduler.c
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#ifndef COMMAND_SCHEDULER_H_
+#define COMMAND_SCHEDULER_H_
+
+#include "main.h"
+
+#define COMMAND_SCHEDULER_DELTAT	10 // Commands are polled at this rate by CommandRun()
+
+/**
+ * @brief How a command runs: either on its own, or as a group of child commands
+ */
+typedef enum
+{
+	CommandBasic,		// Runs Initialize, then Execute every poll until it returns true, then End
+	CommandSequential,	// Runs the children one after another
+	CommandParallel,	// Runs the children together, finishes when all have finished
+	CommandRace,		// Runs the children together, finishes when any has finished and interrupts the others
+	CommandDeadline		// Runs the children together, finishes when the first child has finished and interrupts the others
+} CommandType;
+
+/**
+ * @struct command
+ * A step of an autonomous routine. Commands are plain structs, usually built on the stack by the routine that runs
+ * them, so nothing is allocated.
+ */
+typedef struct command
+{
+	CommandType type;
+	/**
+	 * @brief CommandBasic: called once when the command starts (may be NULL)
+	 */
+	void (*Initialize)(struct command *);
+	/**
+	 * @brief CommandBasic: called every poll, returns true when the command is done (NULL finishes right away)
+	 */
+	bool (*Execute)(struct command *);
+	/**
+	 * @brief CommandBasic: called once when the command finishes, with true if it was interrupted (may be NULL)
+	 */
+	void (*End)(struct command *, bool);
+	/**
+	 * @brief Arguments of a CommandBasic, for use by its functions
+	 */
+	int args[3];
+	double value;
+	/**
+	 * @brief Anything else a CommandBasic needs which does not fit in args, e.g. a path. Must outlive the command.
+	 */
+	const void *data;
+	/**
+	 * @brief Groups: the child commands
+	 */
+	struct command **children;
+	unsigned char numChildren;
+	/**
+	 * @brief Milliseconds after which the command is interrupted, 0 for none
+	 */
+	unsigned long timeout;
+	/**
+	 * @brief CommandBasic: what the command does, e.g. "lift", for the observer (may be NULL)
+	 */
+	const char *name;
+	/**
+	 * @brief Source line the command was built on, 0 if unknown. Set by the profiler wrappers of AutonProfiler.h.
+	 */
+	int line;
+
+	// State, FOR INTERNAL USAGE ONLY (except count, which Execute may use)
+	bool started;
+	bool finished;
+	bool interrupted;
+	unsigned char index;
+	unsigned long startTime;
+	int count;
+	/**
+	 * @brief Free for the observer, e.g. the index of a profiled step
+	 */
+	int tag;
+} Command;
+
+/**
+ * @brief Initializer of a group of commands, e.g. Command both = COMMAND_GROUP(CommandParallel, &lift, &drive);
+ */
+#define COMMAND_GROUP(group, ...)	{ .type = (group), .children = (Command *[]){ __VA_ARGS__ }, \
+	.numChildren = sizeof((Command *[]){ __VA_ARGS__ }) / sizeof(Command *) }
+///@cond
+void CommandStart(Command *);
+bool CommandPoll(Command *);
+void CommandInterrupt(Command *);
+bool CommandRun(Command *);
+void CommandSetObserver(void (*)(Command *, bool));
+Command CommandWait(unsigned long);
+///@endcond
+#endif
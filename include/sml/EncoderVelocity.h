@@ -0,0 +1,109 @@
+/**
+ * @file include/sml/EncoderVelocity.h
+ * @author Elliot Berman
+ * @sa libsml/EncoderVelocity.c @link libsml/EncoderVelocity.c
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#ifndef ENCODER_VELOCITY_H_
+#define ENCODER_VELOCITY_H_
+
+#include "main.h"
+
+#define ENCODER_VELOCITY_MAX_ENCODERS		6 // 12 interrupt capable pins, two per encoder
+#define ENCODER_VELOCITY_MIN_WINDOW			10000 // Minimum microseconds between two velocity samples
+#define ENCODER_VELOCITY_COUNT_THRESHOLD	4 // Edges in a window at which count-based estimation takes over
+#define ENCODER_VELOCITY_TIMEOUT			250000 // Microseconds without an edge before velocity is reported as 0
+
+/**
+ * @struct EncoderVelocity
+ * Represents a quadrature encoder decoded in software so every edge can be timestamped with micros().
+ */
+typedef struct
+{
+	/**
+	 * @brief The digital port of the "top" wire of the encoder
+	 */
+	unsigned char portTop;
+	/**
+	 * @brief The digital port of the "bottom" wire of the encoder
+	 */
+	unsigned char portBottom;
+	/**
+	 * @brief 1 for normal counting, -1 if the encoder was initialized as reversed
+	 */
+	int direction;
+
+	/**
+	 * @brief FOR INTERNAL USAGE ONLY
+	 *
+	 * The last 2-bit quadrature state read from (portTop, portBottom)
+	 */
+	volatile unsigned char state;
+	/**
+	 * @brief FOR INTERNAL USAGE ONLY
+	 *
+	 * The accumulated tick count since initialization, only written by the interrupt handler
+	 */
+	volatile int count;
+	/**
+	 * @brief FOR INTERNAL USAGE ONLY
+	 *
+	 * The raw count at the last reset, subtracted from count when read
+	 */
+	int offset;
+	/**
+	 * @brief FOR INTERNAL USAGE ONLY
+	 *
+	 * +1 or -1, the direction of the most recent edge
+	 */
+	volatile int lastStep;
+	/**
+	 * @brief FOR INTERNAL USAGE ONLY
+	 *
+	 * The micros() timestamp of the most recent edge
+	 */
+	volatile unsigned long lastEdge;
+	/**
+	 * @brief FOR INTERNAL USAGE ONLY
+	 *
+	 * Microseconds between the two most recent edges in the same direction, 0 if unknown
+	 */
+	volatile unsigned long period;
+	/**
+	 * @brief FOR INTERNAL USAGE ONLY
+	 *
+	 * Incremented by the interrupt handler on every edge so readers can detect a torn read
+	 */
+	volatile unsigned int sequence;
+
+	/**
+	 * @brief FOR INTERNAL USAGE ONLY
+	 *
+	 * The tick count when the published velocity was last computed
+	 */
+	int sampleCount;
+	/**
+	 * @brief FOR INTERNAL USAGE ONLY
+	 *
+	 * The micros() timestamp when the published velocity was last computed
+	 */
+	unsigned long sampleTime;
+	/**
+	 * @brief The most recently published velocity, in ticks per second
+	 */
+	int velocity;
+} EncoderVelocity;
+///@cond
+EncoderVelocity *EncoderVelocityInit(unsigned char, unsigned char, bool);
+void EncoderVelocityShutdown(EncoderVelocity *);
+int EncoderVelocityGetCount(EncoderVelocity *);
+void EncoderVelocityReset(EncoderVelocity *);
+int EncoderVelocityGet(EncoderVelocity *);
+///@endcond
+#endif
@@ -0,0 +1,95 @@
+/**
+ * @file include/sml/IMEManager.h
+ * @author Elliot Berman
+ * @sa libsml/IMEManager.c @link libsml/IMEManager.c
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#ifndef IME_MANAGER_H_
+#define IME_MANAGER_H_
+
+#include "main.h"
+
+#define IME_MANAGER_MAX_DEVICES			10 // PROS: more than 10 IMEs causes unreliable communication
+#define IME_MANAGER_RETRIES				2 // Immediate retries of a failed read before giving up on this call
+#define IME_MANAGER_DEGRADED_ERRORS		5 // Consecutive failed reads before a device is marked degraded
+#define IME_MANAGER_BACKOFF_MIN			20 // First backoff after a failed read, in milliseconds
+#define IME_MANAGER_BACKOFF_MAX			1000 // Backoff doubles after every failure up to this, in milliseconds
+#define IME_MANAGER_RESET_DELAY			250 // PROS: wait at least 0.25 seconds between imeShutdown() and imeInitializeAll()
+#define IME_MANAGER_RESET_INTERVAL		2000 // Minimum milliseconds between two bus resets
+#define IME_MANAGER_TASK_DELTAT			100
+#define IME_MANAGER_MUTEX_TIMEOUT		500 // Bus resets and count resets wait this long for the bus, reads only 2 milliseconds
+
+/**
+ * @struct IMEDevice
+ * Represents the health and last known value of one IME on the I2C chain
+ */
+typedef struct
+{
+	/**
+	 * @brief The last successfully read count (offset corrected). Returned in place of a failed read.
+	 */
+	int lastValue;
+	/**
+	 * @brief The last successfully read velocity
+	 */
+	int lastVelocity;
+	/**
+	 * @brief FOR INTERNAL USAGE ONLY
+	 *
+	 * Added to raw counts so that counts continue where they left off after a bus reset
+	 */
+	int offset;
+	/**
+	 * @brief Total number of read attempts
+	 */
+	unsigned int reads;
+	/**
+	 * @brief Total number of failed read attempts
+	 */
+	unsigned int errors;
+	/**
+	 * @brief Number of failed calls since the last successful read
+	 */
+	unsigned int consecutiveErrors;
+	/**
+	 * @brief Duration of the most recent bus transaction in microseconds
+	 */
+	unsigned long latency;
+	/**
+	 * @brief Longest bus transaction seen in microseconds
+	 */
+	unsigned long maxLatency;
+	/**
+	 * @brief FOR INTERNAL USAGE ONLY
+	 *
+	 * Current backoff in milliseconds, 0 if the last read succeeded
+	 */
+	unsigned long backoff;
+	/**
+	 * @brief FOR INTERNAL USAGE ONLY
+	 *
+	 * The device is not read again until millis() reaches this value
+	 */
+	unsigned long backoffUntil;
+	/**
+	 * @brief True if the device has failed IME_MANAGER_DEGRADED_ERRORS reads in a row or is missing from the chain.
+	 *        Controllers should switch to a fallback sensor or open loop while this is set.
+	 */
+	bool degraded;
+} IMEDevice;
+///@cond
+unsigned int IMEManagerInitialize(unsigned char);
+bool IMEManagerGet(unsigned char, int *);
+bool IMEManagerGetVelocity(unsigned char, int *);
+bool IMEManagerReset(unsigned char);
+bool IMEManagerIsDegraded(unsigned char);
+IMEDevice IMEManagerGetStatus(unsigned char);
+unsigned int IMEManagerGetBusResets();
+///@endcond
+#endif
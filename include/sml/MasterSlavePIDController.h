@@ -16,6 +16,8 @@
 #include "main.h"
 #include "sml/SmartMotorLibrary.h"
 
+#define MASTER_SLAVE_PID_DELTAT		15 // Milliseconds between passes of the controller task, and between profile points
+
 /**
  * @struct MasterSlavePIDController
  * Represents two related controllers that need to be synchronized for output.
@@ -50,6 +52,30 @@ typedef struct
 	 * @brief If enabledPrimaryPID = false, both controller outputs are set to this value (along with synchroniation).
 	 */
 	int manualPrimaryOutput;
+	/**
+	 * @brief Goals the controller steps through, one per pass, while profileLength is nonzero. See
+	 *        MasterSlavePIDFollowProfile().
+	 */
+	const short *profile;
+	/**
+	 * @brief Planned speed at each goal of the profile in ticks per second, fed forward with Kv and KvError. NULL for
+	 *        no feedforward.
+	 */
+	const short *profileVelocities;
+	volatile unsigned short profileLength, profileIndex;
+	/**
+	 * @brief Held by the controller task while it steps along the profile, and by whoever starts or stops one
+	 */
+	Mutex profileMutex;
+	/**
+	 * @brief Velocity feedforward while a profile runs, in PWM per tick per second: Kv of the planned speed, KvError of
+	 *        the planned speed the measured speed falls short of. See MasterSlavePIDSetFeedforward().
+	 */
+	double Kv, KvError;
+	/**
+	 * @brief Measured speeds of the master and slave in ticks per second, or NULL for no KvError term
+	 */
+	int (*masterVelocity)(void), (*slaveVelocity)(void);
 } MasterSlavePIDController;
 ///@cond
 MasterSlavePIDController CreateMasterSlavePIDController(PIDController, PIDController, PIDController, int, int, bool);
@@ -57,6 +83,9 @@ TaskHandle InitializeMasterSlaveController(MasterSlavePIDController*, int);
 void MasterSlavePIDSetGoal(MasterSlavePIDController*, int);
 void MasterSlavePIDSetOutput(MasterSlavePIDController*, int);
 void MasterSlavePIDIncreaseGoal(MasterSlavePIDController*, int);
+void MasterSlavePIDFollowProfile(MasterSlavePIDController*, const short*, const short*, unsigned short);
+bool MasterSlavePIDFollowProfileContinuous(MasterSlavePIDController*, const short*, const short*, unsigned short);
+void MasterSlavePIDSetFeedforward(MasterSlavePIDController*, double, double, int(*)(void), int(*)(void));
 bool MasterSlavePIDOnTarget(MasterSlavePIDController*);
 ///@endcond
 #endif
\ No newline at end of file
@@ -143,6 +143,7 @@ void StopMotorManager();
 void MotorManagerTask(void *);
 void MotorConfigure(int, bool, double);
 void MotorChangeRecalculateCommanded(int, int(*foo)(int));
+void MotorChangeSkew(int, double);
 bool MotorSet(int, int, bool);
 int MotorGet(int);
 ///@endcond
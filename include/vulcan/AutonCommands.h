@@ -0,0 +1,34 @@
+/**
+ * @file include/vulcan/AutonCommands.h
+ * @sa vulcan/AutonCommands.c @link vulcan/AutonCommands.c
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#ifndef AUTON_COMMANDS_H_
+#define AUTON_COMMANDS_H_
+
+#include "sml/CommandScheduler.h"
+#include "vulcan/Chassis.h"
+#include "vulcan/Lift.h"
+
+#define CHASSIS_COMMAND_SETTLE		250 // Milliseconds the chassis PID must be on target before a drive finishes
+///@cond
+Command LiftCommandToHeight(int);
+Command LiftCommandSetHeight(int);
+Command LiftCommandFollowTrajectory(const LiftTrajectory *);
+Command ChassisCommandToGoal(int, int);
+Command ChassisCommandSet(int, int, unsigned long);
+Command ChassisCommandMecanum(double, int, int, unsigned long);
+Command ChassisCommandDriveUntil(int, int, const ChassisUntil *);
+Command ChassisCommandMecanumUntil(double, int, int, const ChassisUntil *);
+Command ChassisCommandAlignToLine(int, int, kTiles);
+Command ChassisCommandResetIMEs();
+Command ScoringMechCommandClaw(bool);
+Command ScoringMechCommandNeedle(bool);
+///@endcond
+#endif
@@ -0,0 +1,97 @@
+/**
+ * @file include/vulcan/AutonProfiler.h
+ * @sa vulcan/AutonProfiler.c @link vulcan/AutonProfiler.c
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#ifndef AUTON_PROFILER_H_
+#define AUTON_PROFILER_H_
+
+#include "main.h"
+#include "sml/CommandScheduler.h"
+#include "vulcan/Chassis.h"
+
+#define PROFILER_MAX_STEPS			160
+#define PROFILER_FILE				"profile" // ProfilerSave() writes the breakdown here
+#define PROFILER_LIFT_RATE			120 // Expected lift speed in encoder ticks per second, for planned durations
+#define PROFILER_CHASSIS_RATE		1000 // Expected chassis speed in IME ticks per second, for planned durations
+#define PROFILER_CHASSIS_SETTLE		250 // Milliseconds ChassisGoToGoalCompletion() waits on target
+
+/**
+ * @brief One profiled step of an autonomous routine
+ */
+typedef struct
+{
+	/**
+	 * @brief Name of the profiled function
+	 */
+	const char *name;
+	/**
+	 * @brief Source line of the call
+	 */
+	int line;
+	/**
+	 * @brief First argument of the call (the height, the left goal, or the delay)
+	 */
+	int argument;
+	/**
+	 * @brief Microseconds from ProfilerReset() to the start of the step
+	 */
+	unsigned long start;
+	/**
+	 * @brief Microseconds the step should take: the delay, or the distance at the expected speed
+	 */
+	unsigned long planned;
+	/**
+	 * @brief Microseconds the step took
+	 */
+	unsigned long actual;
+} ProfileStep;
+///@cond
+void ProfilerReset();
+int ProfilerBegin(const char *, int, int, unsigned long);
+void ProfilerEnd(int);
+void ProfilerDump(FILE *);
+bool ProfilerSave();
+void ProfiledDelay(unsigned long, int);
+void ProfiledLiftGoToHeightCompletion(int, int);
+void ProfiledChassisGoToGoalCompletion(int, int, int);
+kChassisStop ProfiledChassisDriveUntil(int, int, const ChassisUntil *, int);
+kChassisStop ProfiledChassisMecanumUntil(double, int, int, const ChassisUntil *, int);
+Command ProfiledCommand(Command, int);
+///@endcond
+
+/*
+ * Include this header last with AUTON_PROFILER_WRAP defined and, under AUTO_DEBUG, every delay(),
+ * LiftGoToHeightCompletion(), ChassisGoToGoalCompletion(), ChassisDriveUntil(), and ChassisMecanumUntil() that
+ * follows is profiled without changing the routine. Commands are profiled as they run wherever they were built; the
+ * command functions below are wrapped only to record the line they were built on.
+ */
+#if defined(AUTO_DEBUG) && defined(AUTON_PROFILER_WRAP)
+#define delay(time)								ProfiledDelay((time), __LINE__)
+#define LiftGoToHeightCompletion(value)			ProfiledLiftGoToHeightCompletion((value), __LINE__)
+#define ChassisGoToGoalCompletion(left, right)	ProfiledChassisGoToGoalCompletion((left), (right), __LINE__)
+#define ChassisDriveUntil(left, right, until)	ProfiledChassisDriveUntil((left), (right), (until), __LINE__)
+#define ChassisMecanumUntil(heading, speed, rotation, until) \
+	ProfiledChassisMecanumUntil((heading), (speed), (rotation), (until), __LINE__)
+#define LiftCommandToHeight(...)				ProfiledCommand(LiftCommandToHeight(__VA_ARGS__), __LINE__)
+#define LiftCommandSetHeight(...)				ProfiledCommand(LiftCommandSetHeight(__VA_ARGS__), __LINE__)
+#define LiftCommandFollowTrajectory(...)		ProfiledCommand(LiftCommandFollowTrajectory(__VA_ARGS__), __LINE__)
+#define ChassisCommandToGoal(...)				ProfiledCommand(ChassisCommandToGoal(__VA_ARGS__), __LINE__)
+#define ChassisCommandSet(...)					ProfiledCommand(ChassisCommandSet(__VA_ARGS__), __LINE__)
+#define ChassisCommandMecanum(...)				ProfiledCommand(ChassisCommandMecanum(__VA_ARGS__), __LINE__)
+#define ChassisCommandDriveUntil(...)			ProfiledCommand(ChassisCommandDriveUntil(__VA_ARGS__), __LINE__)
+#define ChassisCommandMecanumUntil(...)			ProfiledCommand(ChassisCommandMecanumUntil(__VA_ARGS__), __LINE__)
+#define ChassisCommandAlignToLine(...)			ProfiledCommand(ChassisCommandAlignToLine(__VA_ARGS__), __LINE__)
+#define ChassisCommandResetIMEs()				ProfiledCommand(ChassisCommandResetIMEs(), __LINE__)
+#define ScoringMechCommandClaw(...)				ProfiledCommand(ScoringMechCommandClaw(__VA_ARGS__), __LINE__)
+#define ScoringMechCommandNeedle(...)			ProfiledCommand(ScoringMechCommandNeedle(__VA_ARGS__), __LINE__)
+#define PathCommandFollow(...)					ProfiledCommand(PathCommandFollow(__VA_ARGS__), __LINE__)
+#define CommandWait(...)						ProfiledCommand(CommandWait(__VA_ARGS__), __LINE__)
+#endif
+#endif
@@ -0,0 +1,60 @@
+/**
+ * @file include/vulcan/AutonScript.h
+ * @sa vulcan/AutonScript.c @link vulcan/AutonScript.c
+ * @sa tools/autonasm.c @link tools/autonasm.c
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#ifndef AUTON_SCRIPT_H_
+#define AUTON_SCRIPT_H_
+
+#include "main.h"
+
+#define AUTON_SCRIPT_FILE			"auton"
+#define AUTON_SCRIPT_VERSION		1
+#define AUTON_SCRIPT_MAX_SIZE		1024 // Bytes of code
+#define AUTON_SCRIPT_MAX_COMMANDS	96
+#define AUTON_SCRIPT_MAX_DEPTH		16 // Levels of groups, counting the one the assembler wraps the script in
+#define AUTON_SCRIPT_HEADER_SIZE	5 // 'A' 'S' version, then the length of the code (2 bytes, little endian)
+
+/**
+ * @brief Instructions of an autonomous script. Every argument is a 16 bit little endian signed integer.
+ */
+typedef enum
+{
+	AutonOpEnd = 0,			// End of the script
+	AutonOpDrive = 1,		// left, right: chassis PID to IME goals
+	AutonOpSet = 2,			// left, right, milliseconds: chassis open loop, then stop
+	AutonOpMecanum = 3,		// heading (milliradians), speed, rotation, milliseconds: ChassisSetMecanum(), then stop
+	AutonOpLift = 4,		// height: lift to height (0 drives down to the limit switch)
+	AutonOpClaw = 5,		// open: claw
+	AutonOpNeedle = 6,		// on: needle
+	AutonOpWait = 7,		// milliseconds
+	AutonOpUntil = 8,		// condition, value, timeout (milliseconds, 0 for none): wait until condition holds
+	AutonOpReset = 9,		// reset the chassis IMEs
+	AutonOpSequence = 10,	// count (1 byte), then count steps run one after another
+	AutonOpParallel = 11,	// count (1 byte), then count steps run together until all finish
+	AutonOpRace = 12,		// count (1 byte), then count steps run together until any finishes
+	AutonOpDeadline = 13	// count (1 byte), then count steps run together until the first finishes
+} AutonOp;
+
+/**
+ * @brief Conditions of AutonOpUntil
+ */
+typedef enum
+{
+	AutonUntilTime = 0,			// value milliseconds have passed since the script started
+	AutonUntilLiftAbove = 1,	// the left lift encoder is at or above value
+	AutonUntilLiftBelow = 2,	// the left lift encoder is at or below value
+	AutonUntilLine = 3			// either chassis IR sensor sees a line on tile value (see kTiles)
+} AutonUntil;
+///@cond
+bool AutonScriptRun();
+bool AutonScriptReceive();
+///@endcond
+#endif
@@ -32,5 +32,7 @@ void RunBlueCube();
 void RunRedSky();
 void RunRedCube();
 void RunPSkills();
+void RunGhost();
+void RunScript();
 //@endcond
 #endif
\ No newline at end of file
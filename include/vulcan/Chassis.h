@@ -12,12 +12,15 @@
 #ifndef CHASSIS_H_
 #define CHASSIS_H_
 
+#include "sml/SmartMotorLibrary.h"
+
 #define CHASSIS_IR_RIGHT_RED_THRESH		200
 #define CHASSIS_IR_LEFT_RED_THRESH		200
 #define CHASSIS_IR_RIGHT_GREY_THRESH	1800
 #define CHASSIS_IR_LEFT_GREY_THRESH		1800
 #define CHASSIS_IR_RIGHT_BLUE_THRESH	200 //!@todo: Find this value
 #define CHASSIS_IR_LEFT_BLUE_THRESH		200 //!@todo: Find this value
+#define CHASSIS_ALIGN_SETTLE			100 // Milliseconds both IR sensors must be on the line to end an alignment
 
 typedef enum
 {
@@ -26,6 +29,29 @@ typedef enum
 	Grey
 } kTiles;
 
+/**
+ * @brief Conditions which end ChassisDriveUntil() and ChassisMecanumUntil(). The move ends as soon as any one holds.
+ */
+typedef struct
+{
+	int distance;			// IME ticks travelled since the move began (mean of both sides), 0 for none
+	bool line;				// An IR sensor moves onto a line of tile
+	kTiles tile;
+	unsigned char limit;	// Digital port of a limit switch which ends the move when pressed, 0 for none
+	unsigned long timeout;	// Milliseconds, always applies
+} ChassisUntil;
+
+/**
+ * @brief Which condition ended a ChassisDriveUntil() or ChassisMecanumUntil()
+ */
+typedef enum
+{
+	ChassisStopTimeout,
+	ChassisStopDistance,
+	ChassisStopLine,
+	ChassisStopLimit
+} kChassisStop;
+
 ///@cond
 // ---------------- LEFT  SIDE ---------------- //
 void ChassisSetLeft(int, bool);
@@ -42,10 +68,22 @@ bool ChassisHasIRLineRight(kTiles);
 // ---------------- MASTER (ALL) ---------------- //
 void ChassisSet(int, int, bool);
 void ChassisSetMecanum(double, int, int, bool);
+void ChassisSetHolonomic(int, int, int, bool);
+bool ChassisIMEsDegraded();
 void ChassisResetIMEs();
 bool ChassisGoToGoalContinuous(int, int);
 void ChassisGoToGoalCompletion(int, int);
+void ChassisAlignToLineStart(int, int, kTiles);
+bool ChassisAlignToLineContinuous();
 void ChassisAlignToLine(int, int, kTiles);
+void ChassisUntilStart(const ChassisUntil *);
+bool ChassisUntilContinuous(kChassisStop *);
+kChassisStop ChassisDriveUntil(int, int, const ChassisUntil *);
+kChassisStop ChassisMecanumUntil(double, int, int, const ChassisUntil *);
 void ChassisInitialize();
+PIDController *ChassisGetController();
+void ChassisApplyTuning();
+
+extern double ChassisSkewRate;
 ///@endcond
 #endif
\ No newline at end of file
@@ -60,5 +60,6 @@
 #define I2C_MOTOR_CHASSIS_LEFT			1
 #define I2C_MOTOR_LIFT_LEFT				2
 #define I2C_MOTOR_LIFT_RIGHT			3
+#define I2C_NUM_IMES					4
 
 #endif
\ No newline at end of file
@@ -5,13 +5,16 @@
 
 ///@cond
 char * getRobotState();
+void MenuInitialize();
+void MenuOpenAutonSelect();
 ///@endcond
 
 //constants
-#define NUMTITLES	6
+#define NUMTITLES	8
 //external variable for the lcd menus
 extern char *titles[NUMTITLES];
 extern void (*exec[NUMTITLES])();
 extern LCDMenu main_menu;
+extern int AutonSelection;
 
 #endif
\ No newline at end of file
@@ -13,12 +13,52 @@
 #define LIFT_H_
 
 #include "sml/SmartMotorLibrary.h"
+#include "sml/MasterSlavePIDController.h"
+
+#define LIFT_PROFILE_VELOCITY		120 // Cruise speed of a trajectory in quadrature encoder ticks per second
+#define LIFT_PROFILE_ACCELERATION	600 // Ticks per second per second, speeding up and slowing down
+#define LIFT_TRAJECTORY_MAX_POINTS	128 // One every MASTER_SLAVE_PID_DELTAT, enough for the full height of the lift
+#define LIFT_FEEDFORWARD_KV			0.9 // PWM per tick per second of planned speed while following a trajectory
+#define LIFT_FEEDFORWARD_KV_ERROR	0.3 // PWM per tick per second the measured speed lags the planned speed
+
+/**
+ * @brief Indexes of LiftPresetHeights
+ */
+typedef enum
+{
+	LiftHighPost,
+	LiftMediumPost,
+	LiftLowPost,
+	LiftSingleCube,
+	LIFT_NUM_PRESETS
+} LiftPresets;
+
+/**
+ * @brief A trapezoidal move of the lift, computed by LiftTrajectoryCompute() and run by the lift controller
+ */
+typedef struct lift_trajectory
+{
+	/**
+	 * @brief The height the move ends at
+	 */
+	int target;
+	unsigned short numPoints;
+	/**
+	 * @brief Goal of the lift controller at each of its passes
+	 */
+	short points[LIFT_TRAJECTORY_MAX_POINTS];
+	/**
+	 * @brief Planned speed at each point in ticks per second, from the trapezoid rather than the rounded points
+	 */
+	short velocities[LIFT_TRAJECTORY_MAX_POINTS];
+} LiftTrajectory;
 ///@cond
 // ---------------- LEFT  SIDE ---------------- //
 void LiftSetLeft(int, bool);
 int LiftGetCalibIMELeft();
 int LiftGetRawIMELeft();
 int LiftGetQuadEncLeft();
+int LiftGetVelocityLeft();
 int LiftGetCalibPotLeft();
 int LiftGetRawPotLeft();
 
@@ -27,6 +67,7 @@ void LiftSetRight(int, bool);
 int LiftGetCalibIMERight();
 int LiftGetRawIMERight();
 int LiftGetQuadEncRight();
+int LiftGetVelocityRight();
 int LiftGetCalibPotRight();
 int LiftGetRawPotRight();
 
@@ -35,9 +76,16 @@ void LiftSet(int, bool);
 bool LiftSetHeight(int);
 void LiftGoToHeightCompletion(int);
 bool LiftGoToHeightContinuous(int);
+void LiftTrajectoryCompute(LiftTrajectory *, int, int);
+void LiftFollowTrajectory(const LiftTrajectory *);
+bool LiftFollowTrajectoryContinuous(const LiftTrajectory *);
 void LiftInitialize();
+MasterSlavePIDController *LiftGetController();
+void LiftApplyTuning();
 
 PIDController LiftPIDController_l, LiftPIDController_r;
 extern int skyriseBuilt;
+extern double LiftSkewRate;
+extern int LiftPresetHeights[LIFT_NUM_PRESETS];
 ///@endcond
 #endif
\ No newline at end of file
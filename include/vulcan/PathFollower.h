@@ -0,0 +1,69 @@
+/**
+ * @file include/vulcan/PathFollower.h
+ * @sa vulcan/PathFollower.c @link vulcan/PathFollower.c
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#ifndef PATH_FOLLOWER_H_
+#define PATH_FOLLOWER_H_
+
+#include "main.h"
+#include "sml/CommandScheduler.h"
+
+#define PATH_TICKS_PER_RADIAN		374 // Wheel travel (IME ticks) for each radian the chassis turns in place
+#define PATH_IME_STRAFE_SIGN		1 // 1 if the chassis IMEs are on the front wheels, -1 if on the rear wheels
+#define PATH_TOLERANCE				40 // The path is done once the chassis is this many ticks from its end...
+#define PATH_HEADING_TOLERANCE		0.05 // ...and this many radians from its final heading
+#define PATH_HEADING_KP				90.0 // Rotation per radian of heading error
+#define PATH_SLOWDOWN				600 // Ticks before the end of the path over which speed ramps down
+#define PATH_MIN_SPEED				30 // Slowest speed while ramping down, enough to overcome friction
+
+/**
+ * @brief A point of a path, in IME ticks from where PathStart() was called: x forward, y left. heading is the
+ *        direction the chassis should face there, in radians counterclockwise from its heading at the start.
+ */
+typedef struct
+{
+	int x, y;
+	double heading;
+} Waypoint;
+
+/**
+ * @struct Path
+ * A list of at least 2 waypoints, the first normally being { 0, 0, 0 }
+ */
+typedef struct
+{
+	const Waypoint *points;
+	unsigned char numPoints;
+	/**
+	 * @brief [0,127] Cruising speed
+	 */
+	int speed;
+	/**
+	 * @brief Distance in ticks to the point on the path the chassis steers toward. Longer is smoother but cuts
+	 *        corners more.
+	 */
+	int lookahead;
+} Path;
+
+/**
+ * @brief Estimated position of the chassis, in the units of Waypoint
+ */
+typedef struct
+{
+	double x, y, heading;
+} Pose;
+///@cond
+void PathStart(const Path *);
+bool PathFollowContinuous();
+void PathFollowCompletion(const Path *);
+Pose PathGetPose();
+Command PathCommandFollow(const Path *);
+///@endcond
+#endif
@@ -0,0 +1,46 @@
+/**
+ * @file include/vulcan/SkyrisePlan.h
+ * @sa vulcan/SkyrisePlan.c @link vulcan/SkyrisePlan.c
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#ifndef SKYRISE_PLAN_H_
+#define SKYRISE_PLAN_H_
+
+#include "vulcan/Lift.h"
+
+#define SKYRISE_LEVELS			7
+#define SKYRISE_GRAB_HEIGHT		15 // Lift height which carries a grabbed section clear of the autoloader and the base
+
+/**
+ * @brief How one section of the skyrise is stacked. Level n is the section put on top of n built sections.
+ */
+typedef struct
+{
+	/**
+	 * @brief Lift height the section is stacked at
+	 */
+	int height;
+	/**
+	 * @brief [-127,127] Speed the chassis backs the section up to the skyrise at in autonomous
+	 */
+	int approach;
+	/**
+	 * @brief Lift height dropped to as the claw opens so the section settles onto the skyrise, 0 to hold the height
+	 */
+	int release;
+} SkyriseLevel;
+
+extern const SkyriseLevel SkyrisePlan[SKYRISE_LEVELS];
+extern LiftTrajectory SkyriseCarryTrajectories[SKYRISE_LEVELS];
+extern LiftTrajectory SkyriseStackTrajectories[SKYRISE_LEVELS];
+
+///@cond
+void SkyrisePlanInitialize();
+///@endcond
+#endif
@@ -45,8 +45,31 @@ typedef enum
 	LCD_CENT = 25,
 	LCD_RIGHT = 26
 } buttons;
+
+/**
+ * @brief The bit of a button in the masks returned by buttonsGetMask(), buttonsGetPressed(), and buttonsGetReleased()
+ */
+#define BUTTON_MASK(button)		(1UL << (button))
+
+/**
+ * @brief The edges of a button a callback can be subscribed to
+ */
+typedef enum
+{
+	ButtonPress,
+	ButtonRelease
+} ButtonEdge;
 ///@cond
 void initButtons();
+unsigned long buttonsRead();
+void buttonsSample();
+void buttonsSampleMask(unsigned long);
 bool buttonIsNewPress(buttons);
+bool buttonIsNewRelease(buttons);
+bool buttonIsDown(buttons);
+unsigned long buttonsGetMask();
+unsigned long buttonsGetPressed();
+unsigned long buttonsGetReleased();
+bool buttonSubscribe(buttons, ButtonEdge, void (*)(buttons));
 ///@endcond
 #endif 
\ No newline at end of file
@@ -0,0 +1,36 @@
+/**
+ * @file include/vulcan/ghost.h
+ * @sa vulcan/ghost.c @link vulcan/ghost.c
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#ifndef GHOST_H_
+#define GHOST_H_
+
+#include "vulcan/joystick.h"
+
+#define GHOST_FILE				"ghost"
+#define GHOST_BUFFER_SIZE		4096 // A recording is kept in RAM and written to flash when it stops
+#define GHOST_MAX_DURATION		15000 // Recordings stop after the length of the autonomous period
+#define GHOST_VERSION			1
+
+typedef enum
+{
+	GhostIdle,
+	GhostRecording,
+	GhostPlaying,
+	GhostSaving // A finished recording is being written to flash in the background
+} GhostState;
+///@cond
+const JoystickSnapshot *GhostSample();
+bool GhostRecordStart();
+void GhostRecordStop();
+bool GhostPlaybackStart();
+GhostState GhostGetState();
+///@endcond
+#endif
@@ -0,0 +1,46 @@
+/**
+ * @file include/vulcan/joystick.h
+ * @sa vulcan/joystick.c @link vulcan/joystick.c
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#ifndef JOYSTICK_H_
+#define JOYSTICK_H_
+
+#define JOYSTICK_NUM				2
+#define JOYSTICK_NUM_AXES			4 // Channels 1 to 4, the accelerometer channels are not sampled
+#define JOYSTICK_DEFAULT_DEADBAND	0 // The drive mixers apply THRESHOLD to all axes at once, as they always have
+#define JOYSTICK_DEFAULT_EXPO		0
+
+/**
+ * @struct JoystickSnapshot
+ * The analog axes of both joysticks, read once per control loop tick by JoystickSample()
+ */
+typedef struct
+{
+	/**
+	 * @brief analog[joystick - 1][axis - 1] is the axis after deadband, expo, and inversion [-127,127]
+	 */
+	int analog[JOYSTICK_NUM][JOYSTICK_NUM_AXES];
+	/**
+	 * @brief The axes as returned by joystickGetAnalog()
+	 */
+	int raw[JOYSTICK_NUM][JOYSTICK_NUM_AXES];
+	/**
+	 * @brief The millis() timestamp of the snapshot
+	 */
+	unsigned long time;
+} JoystickSnapshot;
+///@cond
+void JoystickInitialize();
+void JoystickConfigureAxis(unsigned char, unsigned char, unsigned char, unsigned char, bool);
+const JoystickSnapshot *JoystickSample();
+const JoystickSnapshot *JoystickInject(signed char [JOYSTICK_NUM][JOYSTICK_NUM_AXES]);
+int JoystickGetAnalog(unsigned char, unsigned char);
+///@endcond
+#endif
@@ -12,15 +12,97 @@
 #ifndef MECHOP_H
 #define MECHOP_H
 #define STRAFE_CONST	254
-#define THRESHOLD		25
+#define TELEOP_DELTAT	15 // Period of the teleop loops in milliseconds, recorded ghost drivers depend on it
+#define THRESHOLD		25 // The drive mixers stop the chassis while every axis is below this
+#include "vulcan/buttons.h"
+
+struct lift_trajectory; // LiftTrajectory of vulcan/Lift.h, which pulls in the PROS API
+
+/**
+ * @brief What a button does in a driver profile
+ */
+typedef enum
+{
+	DriverLiftHeight,		// Sends the lift to *height with the PID controller
+	DriverReverse,			// Toggles reversed axes (forward is backward, for building skyrises)
+	DriverSwitchProfile,	// Hands the controls to DriverProfiles[profile]
+	DriverAutonomous		// Runs the selected autonomous
+} DriverAction;
+
+/**
+ * @struct DriverBinding
+ * A button of a driver profile and what a new press of it does
+ */
+typedef struct
+{
+	buttons button;
+	DriverAction action;
+	/**
+	 * @brief DriverLiftHeight: the height, read when pressed so presets tuned from the LCD apply right away
+	 */
+	const int *height;
+	/**
+	 * @brief DriverSwitchProfile: index of the profile in DriverProfiles
+	 */
+	int profile;
+} DriverBinding;
+
+/**
+ * @struct DriverProfile
+ * The controls of one driver, interpreted by TeleopRun()
+ */
+typedef struct
+{
+	/**
+	 * @brief Printed on the LCD while the profile drives
+	 */
+	const char *title, *subtitle;
+	/**
+	 * @brief The drive mixer: JoystickControl() snaps to eight directions, HolonomicControl() is continuous
+	 */
+	void (*drive)(int, int, int, int);
+	/**
+	 * @brief The joystick 1 axes passed to drive as r1, r2, l3, and l4. Negative channels are negated. reversedAxes is
+	 *        used instead of axes while DriverReverse is on.
+	 */
+	signed char axes[4], reversedAxes[4];
+	const DriverBinding *bindings;
+	unsigned char numBindings;
+	/**
+	 * @brief Trajectory the lift follows when the claw closes on a skyrise with the lift down:
+	 *        clawLiftTrajectories[skyriseBuilt] while there are entries, then straight to clawLiftDefault. If
+	 *        countSkyrises, every such grab counts as a skyrise.
+	 */
+	const struct lift_trajectory *clawLiftTrajectories;
+	unsigned char numClawLiftTrajectories;
+	int clawLiftDefault;
+	bool countSkyrises;
+} DriverProfile;
+
+/**
+ * @brief Indices of DriverProfiles
+ */
+typedef enum
+{
+	DriverJosh,
+	DriverSam,
+	NUM_DRIVER_PROFILES
+} Drivers;
+
+extern const DriverProfile DriverProfiles[NUM_DRIVER_PROFILES];
+
 ///@cond
 double getJoyTheta(int, int);
 int thetaSector(double);
 int aJoy(int, int);
 double cHypo(int, int);
 int aHypo(double, double);
+int joySector(int, int);
+int joyHypoAverage(int, int, int, int);
 void JoystickControl(int, int, int, int);
+void HolonomicControl(int, int, int, int);
 
+void TeleopRun(const DriverProfile *);
 void JoshControl();
 void SamControl();
 ///@endcond
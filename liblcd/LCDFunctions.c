@@ -9,13 +9,82 @@
  * @endhtmlonly
  ********************************************************************************/
 
-#include "lcd\LCDFunctions.h"
-
 #include "main.h"
 #include <stdarg.h>
+#include "lcd/LCDFunctions.h"
 #include "lcd/vexprintf.h"
 
-static Mutex mutex_line1, mutex_line2;
+#define LCD_WIDTH				16
+#define LCD_TEXT_SIZE			48 // Formatted text is cut off at 47 characters
+#define LCD_RENDER_DELTAT		50 // A full line is 22 bytes at 19200 baud (~12 ms), so both lines fit well within one cycle
+#define LCD_MUTEX_TIMEOUT		5
+#define LCD_LINE_MIN_INTERVAL	100 // Minimum milliseconds between two updates of the same line, changes in between are coalesced
+#define LCD_LINE_PACKET_SIZE	22 // Bytes lcdSetText() sends per line: 16 characters plus sync, command, line, and checksum
+#define LCD_MARQUEE_STEP		175 // Default milliseconds between two shifts of a long text
+#define LCD_MARQUEE_PAUSE		450 // Default milliseconds a long text rests at either end
+
+/**
+ * @brief Framebuffer of one LCD line. lcdprint* functions write into it, lcdRenderTask pushes it to the LCD.
+ */
+typedef struct
+{
+	/**
+	 * @brief The text that should currently be on the LCD, space padded
+	 */
+	char frame[LCD_WIDTH + 1];
+	/**
+	 * @brief True if frame has changed since it was last pushed to the LCD
+	 */
+	bool dirty;
+	/**
+	 * @brief The text last pushed to the LCD
+	 */
+	char sent[LCD_WIDTH + 1];
+	/**
+	 * @brief The millis() timestamp of the last push to the LCD
+	 */
+	unsigned long sentTime;
+	/**
+	 * @brief Bytes sent and suppressed on this line
+	 */
+	LCDStats stats;
+	/**
+	 * @brief frame may not be replaced before millis() reaches this value (see lcdprint_d() duration)
+	 */
+	unsigned long holdUntil;
+	/**
+	 * @brief The full text if it is too long for the line and scrolls (marqueeLength is 0 otherwise)
+	 */
+	char marquee[LCD_TEXT_SIZE];
+	textJustifications marqueeJustification;
+	unsigned char marqueeLength;
+	/**
+	 * @brief Index of the first character of marquee on the LCD
+	 */
+	unsigned char marqueePosition;
+	/**
+	 * @brief The millis() timestamp of the next shift
+	 */
+	unsigned long marqueeNext;
+	/**
+	 * @brief The most recent text printed while frame was held. Only the latest one is kept.
+	 */
+	char pending[LCD_TEXT_SIZE];
+	textJustifications pendingJustification;
+	/**
+	 * @brief The duration pending should be held for once it is shown
+	 */
+	unsigned long pendingDuration;
+	/**
+	 * @brief True if pending contains text waiting to be shown
+	 */
+	bool hasPending;
+	Mutex mutex;
+} LCDLine;
+
+static LCDLine Lines[2];
+static TaskHandle lcdRenderTaskHandle;
+static unsigned long MarqueeStep = LCD_MARQUEE_STEP, MarqueePause = LCD_MARQUEE_PAUSE;
 
 /**
  * @brief Returns the length of a string. Same functionality as strlen in <cstring>
@@ -34,22 +103,205 @@ static size_t strlen(const char *str)
 }
 
 /**
- * @brief Subtracts a number from an unsigned long, not allowing to to flip over, a - b
+ * @brief Copies a 16 character frame (and its terminator)
+ */
+static void lcdCopyFrame(char *dest, const char *src)
+{
+	for (int i = 0; i <= LCD_WIDTH; i++)
+		dest[i] = src[i];
+}
+
+/**
+ * @brief Returns true if two 16 character frames are identical
+ */
+static bool lcdFrameEquals(const char *a, const char *b)
+{
+	for (int i = 0; i < LCD_WIDTH; i++)
+		if (a[i] != b[i])
+			return false;
+	return true;
+}
+
+/**
+ * @brief Counts a line update that never reached the LCD
+ */
+static void lcdSuppress(LCDLine *l)
+{
+	l->stats.linesSuppressed++;
+	l->stats.bytesSuppressed += LCD_LINE_PACKET_SIZE;
+}
+
+/**
+ * @brief Replaces the frame of a line, skipping identical frames and coalescing with a frame that was not sent yet
+ */
+static void lcdSetFrame(LCDLine *l, const char *out)
+{
+	if (lcdFrameEquals(l->frame, out))
+		lcdSuppress(l); // Nothing changed
+	else
+	{
+		if (l->dirty)
+			lcdSuppress(l); // The previous frame was never sent and is coalesced into this one
+		lcdCopyFrame(l->frame, out);
+		l->dirty = true;
+	}
+}
+
+/**
+ * @brief Shows the 16 characters of the marquee starting at its current position
+ */
+static void lcdShowMarquee(LCDLine *l)
+{
+	char out[LCD_WIDTH + 1];
+	for (int i = 0; i < LCD_WIDTH; i++)
+		out[i] = l->marquee[l->marqueePosition + i];
+	out[LCD_WIDTH] = '\0';
+	lcdSetFrame(l, out);
+}
+
+/**
+ * @brief Puts text on a line. Text that fits is justified, longer text becomes a marquee which the LCD render task
+ *        scrolls. Printing the same long text again does not restart its scrolling.
  *
- * @param a
- *			A pointer to an unsigned long
+ * @pre The line mutex is held
+ */
+static void lcdLineSetText(LCDLine *l, textJustifications justification, const char *string)
+{
+	int length = strlen(string);
+	if (length > LCD_TEXT_SIZE - 1)
+		length = LCD_TEXT_SIZE - 1;
+
+	if (length > LCD_WIDTH && MarqueeStep != 0)
+	{
+		bool same = (justification == l->marqueeJustification && length == l->marqueeLength);
+		for (int i = 0; same && i < length; i++)
+			same = (l->marquee[i] == string[i]);
+		if (same)
+		{
+			lcdSuppress(l);
+			return;
+		}
+
+		for (int i = 0; i < length; i++)
+			l->marquee[i] = string[i];
+		l->marquee[length] = '\0';
+		l->marqueeLength = length;
+		l->marqueeJustification = justification;
+		// Right justified text scrolls from its end back to its beginning
+		l->marqueePosition = (justification == Right) ? length - LCD_WIDTH : 0;
+		l->marqueeNext = millis() + MarqueePause;
+		lcdShowMarquee(l);
+		return;
+	}
+
+	char out[LCD_WIDTH + 1];
+	l->marqueeLength = 0;
+	for (int i = 0; i < LCD_WIDTH; i++)
+		out[i] = ' ';
+	out[LCD_WIDTH] = '\0';
+
+	if (length > LCD_WIDTH)
+	{
+		// Too long for the screen and scrolling is off, show the end of the string if right justified, the beginning otherwise
+		int start = (justification == Right) ? length - LCD_WIDTH : 0;
+		for (int i = 0; i < LCD_WIDTH; i++)
+			out[i] = string[start + i];
+	}
+	else
+	{ // Less than 16 characters, use text justification strategy to align text on screen
+		int start;
+		switch (justification)
+		{
+			case Centered:
+				start = (LCD_WIDTH - length) / 2;
+				break;
+			case Right:
+				start = LCD_WIDTH - length;
+				break;
+			default:
+				start = 0;
+				break;
+		}
+		for (int i = 0; i < length; i++)
+			out[start + i] = string[i];
+	}
+	lcdSetFrame(l, out);
+}
+
+/**
+ * @brief Shifts a marquee by one character if it is time to. At either end it rests for MarqueePause, then starts over.
  *
- * @param b
- *			The number to subtract
+ * @pre The line mutex is held
+ */
+static void lcdStepMarquee(LCDLine *l)
+{
+	if (l->marqueeLength == 0 || millis() < l->marqueeNext)
+		return;
+
+	unsigned char last = l->marqueeLength - LCD_WIDTH;
+	unsigned char first = (l->marqueeJustification == Right) ? last : 0;
+	unsigned char end = (l->marqueeJustification == Right) ? 0 : last;
+
+	if (l->marqueePosition == end)
+		l->marqueePosition = first;
+	else
+		l->marqueePosition += (l->marqueeJustification == Right) ? -1 : 1;
+
+	bool resting = (l->marqueePosition == end || l->marqueePosition == first);
+	l->marqueeNext = millis() + (resting ? MarqueePause : MarqueeStep);
+	lcdShowMarquee(l);
+}
+
+/**
+ * @brief Background task which pushes changed lines of the framebuffer to the LCD. The line mutex is only held to copy
+ *        the frame, so printing never waits on the UART. A line is only sent if it differs from what the LCD already
+ *        shows, and at most once every LCD_LINE_MIN_INTERVAL milliseconds.
  */
-static void subtract(unsigned long *a, int b)
+static void lcdRenderTask(void *none)
 {
-	if (*a > b) *a -= b;
-	else *a = 0;
+	unsigned long wakeTime = millis();
+	char out[LCD_WIDTH + 1];
+	while (true)
+	{
+		for (int line = 0; line < 2; line++)
+		{
+			LCDLine *l = &Lines[line];
+			bool send = false;
+			if (!mutexTake(l->mutex, LCD_MUTEX_TIMEOUT))
+				continue;
+			if (l->hasPending && millis() >= l->holdUntil)
+			{
+				lcdLineSetText(l, l->pendingJustification, l->pending);
+				l->holdUntil = millis() + l->pendingDuration;
+				l->hasPending = false;
+			}
+			lcdStepMarquee(l);
+			if (l->dirty && millis() - l->sentTime >= LCD_LINE_MIN_INTERVAL)
+			{
+				l->dirty = false;
+				if (lcdFrameEquals(l->frame, l->sent))
+					lcdSuppress(l);
+				else
+				{
+					lcdCopyFrame(out, l->frame);
+					lcdCopyFrame(l->sent, l->frame);
+					l->sentTime = millis();
+					l->stats.linesSent++;
+					l->stats.bytesSent += LCD_LINE_PACKET_SIZE;
+					send = true;
+				}
+			}
+			mutexGive(l->mutex);
+
+			if (send)
+				lcdSetText(uart1, line + 1, out);
+		}
+		taskDelayUntil(&wakeTime, LCD_RENDER_DELTAT);
+	}
 }
 
 /**
- * @brief Intializes the LCD screen at uart1, turns on backlight, and creates mutexes
+ * @brief Intializes the LCD screen at uart1, turns on backlight, and creates the framebuffer and LCD render task
  */
 void lcdInitialize()
 {
@@ -57,12 +309,58 @@ void lcdInitialize()
 	lcdInit(uart1);
 	lcdSetBacklight(uart1, true);
 	delay(10);
-	mutex_line1 = mutexCreate();
-	mutex_line2 = mutexCreate();
+	for (int line = 0; line < 2; line++)
+	{
+		if (Lines[line].mutex == NULL)
+			Lines[line].mutex = mutexCreate();
+		for (int i = 0; i < LCD_WIDTH; i++)
+			Lines[line].frame[i] = ' ';
+		Lines[line].frame[LCD_WIDTH] = '\0';
+		// The LCD was just cleared, make sure the next frame is sent
+		Lines[line].sent[0] = '\0';
+		Lines[line].marqueeLength = 0;
+		Lines[line].dirty = true;
+	}
+	if (lcdRenderTaskHandle == NULL)
+		lcdRenderTaskHandle = taskCreate(&lcdRenderTask, TASK_MINIMAL_STACK_SIZE * 2, NULL, TASK_PRIORITY_LOWEST + 1);
 }
 
 /**
- * @brief Prints a string on the LCD Screen. If the length of the string is greater than 16 (the max number of character spaces), the text will scroll across the screen.
+ * @brief Configures how text longer than 16 characters scrolls. Scrolling happens in the LCD render task, so the caller
+ *        never waits for it.
+ *
+ * @param step
+ *			Milliseconds between two shifts by one character (default 175). Each line is updated at most every 100
+ *			milliseconds. 0 turns scrolling off and clips long text instead.
+ *
+ * @param pause
+ *			Milliseconds the text rests at its beginning and end before scrolling (default 450)
+ */
+void lcdSetMarquee(unsigned long step, unsigned long pause)
+{
+	MarqueeStep = step;
+	MarqueePause = pause;
+}
+
+/**
+ * @brief Returns the number of bytes sent to and suppressed from the LCD since initialization, summed over both lines
+ */
+LCDStats lcdGetStats()
+{
+	LCDStats stats = { 0, 0, 0, 0 };
+	for (int line = 0; line < 2; line++)
+	{
+		stats.bytesSent += Lines[line].stats.bytesSent;
+		stats.bytesSuppressed += Lines[line].stats.bytesSuppressed;
+		stats.linesSent += Lines[line].stats.linesSent;
+		stats.linesSuppressed += Lines[line].stats.linesSuppressed;
+	}
+	return stats;
+}
+
+/**
+ * @brief Prints a string on the LCD Screen. Only the framebuffer is written; the LCD render task sends it to the LCD,
+ *        so this returns without waiting on the UART.
  *
  * @param justification
  *        A text justification strategy to use to print if the number of characters is less than 16
@@ -73,108 +371,46 @@ void lcdInitialize()
  *        The line to write the text to [1,2]
  *
  * @param duration
- *		Minimum duration of display in milliseconds
+ *		Minimum duration of display in milliseconds. Text printed to the line during this time is not lost: the most
+ *		recent text is shown once the duration has passed.
  *
  * @param string
  *        An array of characters to write to the LCD Screen
  *
- * @returns Returns true if lcdprintf() was successful
+ * @returns Returns true if lcdprint_d() was successful
  */
 bool lcdprint_d(textJustifications justification, unsigned char line, unsigned long duration, char * string)
 {
-	if (mutex_line1 == NULL || mutex_line2 == NULL)
+	if (line != 1 && line != 2)
+		return false;
+	if (Lines[line - 1].mutex == NULL)
 		lcdInitialize();
 
-	// If we're unable to take the mutex of the given line or the queried line is not valid, return false b/c unable to print
-	if ((line == 1 && !mutexTake(mutex_line1, 2000)) ||
-		(line == 2 && !mutexTake(mutex_line2, 2000)) ||
-		(line != 1 && line != 2))
+	LCDLine *l = &Lines[line - 1];
+	if (!mutexTake(l->mutex, LCD_MUTEX_TIMEOUT))
 		return false;
-
-	if (strlen(string) > 16)
+	if (millis() < l->holdUntil)
 	{
-		char out[16];
-		switch (justification)
-		{
-			case Right:
-				// Fill text from right to left of what we can (last 16 characters)
-				for (int i = 0, j = strlen(string) - 16; i < 16; i++, j++)
-					out[i] = string[j];
-				lcdPrint(uart1, line, out);
-				delay(450);
-				subtract(&duration, 450);
-				for (int i = strlen(string) - 16; i >= 0; i--)
-				{
-					// Shift all characters on screen to the right by one
-					for (int j = 15; j > 0; j--)
-						out[j - 1] = out[j];
-					// Fill last character on screen with new character
-					out[15] = string[i];
-					lcdPrint(uart1, line, out);
-					delay(175);
-					subtract(&duration, 175);
-				}
-				break;
-			default:
-				// Fill text from left to right of what we can (first 16 characters)
-				for (int i = 0; i < 16; i++)
-					out[i] = string[i];
-				lcdPrint(uart1, line, out);
-				delay(450);
-				subtract(&duration, 450);
-				// Iterate through each of the rest of the characters
-				for (int i = 16; i <= strlen(string); i++)
-				{
-					// Shift all characters on screen left by one
-					for (int j = 0; j < 15; j++)
-						out[j] = out[j + 1];
-					// Fill last character on screen with new character
-					out[15] = string[i];
-					lcdPrint(uart1, line, out);
-					subtract(&duration, 175);
-				}
-
-				break;
-		}
+		int i = 0;
+		for (; i < LCD_TEXT_SIZE - 1 && string[i] != '\0'; i++)
+			l->pending[i] = string[i];
+		l->pending[i] = '\0';
+		l->pendingJustification = justification;
+		l->pendingDuration = duration;
+		l->hasPending = true;
 	}
 	else
-	{ // Less than 16 characters, use text justification strategy to align text on screen
-		char out[16];
-		for (int i = 0; i < 16; i++)
-			out[i] = ' ';
-		switch (justification)
-		{
-			case Left: // Left justification, nothing to do but print
-				lcdPrint(uart1, line, string);
-				break;
-			case Centered: // Center justification
-				for (int i = (16 - (strlen(string) % 16)) / 2, j = 0; j < strlen(string); i++, j++)
-					out[i] = string[j];
-
-				lcdPrint(uart1, line, out);
-				break;
-			case Right: // Right justification
-				for (int i = 16 - strlen(string), j = 0; i < 16; i++, j++)
-					out[i] = string[j];
-				lcdPrint(uart1, line, out);
-				break;
-			default:
-				lcdPrint(uart1, line, string);
-				break;
-		}
+	{
+		l->holdUntil = millis() + duration;
+		l->hasPending = false;
+		lcdLineSetText(l, justification, string);
 	}
-
-	delay(duration);
-
-	if (line == 1)
-		mutexGive(mutex_line1);
-	else if (line == 2)
-		mutexGive(mutex_line2);
+	mutexGive(l->mutex);
 	return true;
 }
 
 /**
- * @brief Prints a string on the LCD Screen. If the length of the string is greater than 16 (the max number of character spaces), the text will scroll across the screen.
+ * @brief Prints a string on the LCD Screen. If the length of the string is greater than 16 (the max number of character spaces), the text will scroll across the screen in the background.
  *
  * @param justification
  *        A text justification strategy to use to print if the number of characters is less than 16
@@ -197,13 +433,13 @@ bool lcdprint_d(textJustifications justification, unsigned char line, unsigned l
  */
 bool lcdprint_dv(textJustifications justification, unsigned char line, unsigned long duration, char * stringFormat, va_list args)
 {
-	char string[128];
-	vex_vsprintf(string, stringFormat, args);
+	char string[LCD_TEXT_SIZE];
+	vex_vsnprintf(string, LCD_TEXT_SIZE, stringFormat, args);
 	return lcdprint_d(justification, line, duration, string);
 }
 
 /**
- * @brief Prints a string on the LCD Screen. If the length of the string is greater than 16 (the max number of character spaces), the text will scroll across the screen. 
+ * @brief Prints a string on the LCD Screen. If the length of the string is greater than 16 (the max number of character spaces), the text will scroll across the screen in the background. 
  *
  * @param justification
  *        A text justification strategy to use to print if the number of characters is less than 16
@@ -226,17 +462,17 @@ bool lcdprint_dv(textJustifications justification, unsigned char line, unsigned
  */
 bool lcdprint_df(textJustifications justification, unsigned char line, unsigned long duration, char * stringFormat, ...)
 {
-	char string[128];
+	char string[LCD_TEXT_SIZE];
 	va_list args;
 	va_start(args, stringFormat);
-	vex_vsprintf(string, stringFormat, args);
+	vex_vsnprintf(string, LCD_TEXT_SIZE, stringFormat, args);
 	va_end(args);
 
 	return lcdprint_d(justification, line, duration, string);
 }
 
 /**
- * @brief Prints a string on the LCD Screen. If the length of the string is greater than 16 (the max number of character spaces), the text will scroll across the screen.
+ * @brief Prints a string on the LCD Screen. If the length of the string is greater than 16 (the max number of character spaces), the text will scroll across the screen in the background.
  *
  * @param justification 
  *        A text justification strategy to use to print if the number of characters is less than 16
@@ -250,8 +486,6 @@ bool lcdprint_df(textJustifications justification, unsigned char line, unsigned
  *        An array of characters to write to the LCD Screen
  *
  * @returns Returns true if lcdprintf() was successful
- *
- * @warning Text will take longer to display if longer than 16 characters (LCD screen limitation) in order to cycle through all characters. This may cause undesired delays in program execution
  */
 bool lcdprint(textJustifications justification, unsigned char line, char * string)
 {
@@ -259,7 +493,7 @@ bool lcdprint(textJustifications justification, unsigned char line, char * strin
 }
 
 /**
- * @brief Prints a string on the LCD Screen. If the length of the string is greater than 16 (the max number of character spaces), the text will scroll across the screen.
+ * @brief Prints a string on the LCD Screen. If the length of the string is greater than 16 (the max number of character spaces), the text will scroll across the screen in the background.
 
  * @param justification
  *        A text justification strategy to use to print if the number of characters is less than 16
@@ -276,18 +510,16 @@ bool lcdprint(textJustifications justification, unsigned char line, char * strin
  *			A list of optional arguments for the string format
  *
  * @returns Returns true if lcdprintv() was successful
-
- * @warning Text will take longer to display if longer than 16 characters (LCD screen limitation) in order to cycle through all characters. This may cause undesired delays in program execution
  */
 bool lcdprintv(textJustifications justification, unsigned char line, char * stringFormat, va_list args)
 {
-	char string[128];
-	vex_vsprintf(string, stringFormat, args);
+	char string[LCD_TEXT_SIZE];
+	vex_vsnprintf(string, LCD_TEXT_SIZE, stringFormat, args);
 	return lcdprint(justification, line, string);
 }
 
 /**
- * @brief Prints a string on the LCD Screen. If the length of the string is greater than 16 (the max number of character spaces), the text will scroll across the screen.
+ * @brief Prints a string on the LCD Screen. If the length of the string is greater than 16 (the max number of character spaces), the text will scroll across the screen in the background.
  *
  * @param justification
  *        A text justification strategy to use to print if the number of characters is less than 16
@@ -304,16 +536,44 @@ bool lcdprintv(textJustifications justification, unsigned char line, char * stri
  *			A list of optional arguments for the string format
  *
  * @returns Returns true if lcdprintf() was successful
- *
- * @warning Text will take longer to display if longer than 16 characters (LCD screen limitation) in order to cycle through all characters. This may cause undesired delays in program execution
  */
 bool lcdprintf(textJustifications justification, unsigned char line, char * stringFormat, ...)
 {
-	char string[128];
+	char string[LCD_TEXT_SIZE];
 	va_list args;
 	va_start(args, stringFormat);
-	vex_vsprintf(string, stringFormat, args);
+	vex_vsnprintf(string, LCD_TEXT_SIZE, stringFormat, args);
 	va_end(args);
 	
 	return lcdprint(justification, line, string);
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Prints a compiled format on the LCD Screen. Use instead of lcdprintf() in loops, the format string is only
+ *        parsed once by lcdformatCompile().
+ *
+ * @param justification
+ *        A text justification strategy to use to print if the number of characters is less than 16
+ *        Left, Centered, and Right
+ *
+ * @param line
+ *        The line to write the text to [1,2]
+ *
+ * @param format
+ *        A format compiled with lcdformatCompile()
+ *
+ * @param ...
+ *			The arguments of the format
+ *
+ * @returns Returns true if lcdprintc() was successful
+ */
+bool lcdprintc(textJustifications justification, unsigned char line, const LCDFormat *format, ...)
+{
+	char string[LCD_TEXT_SIZE];
+	va_list args;
+	va_start(args, format);
+	lcdformatRenderv(format, string, LCD_TEXT_SIZE, args);
+	va_end(args);
+
+	return lcdprint(justification, line, string);
+}
@@ -2,11 +2,14 @@
  * @file liblcd/LCDManager.c
  * @author Elliot Berman
  * @brief Source for the LCD Manager. LCD Manager is a background task that cycles
- *	      through user defined text displays when not being overriden by another
- *        display.
+ *	      through user defined pages on each line of the LCD.
  *
- * @todo Work out bugs in LCDManager. LCD Manager is not ready for prime production 
- *		 code
+ * @details Every page has a priority and a dwell time. Only the active pages of the highest priority
+ *          present on a line are cycled, in the order they were added, each for its own dwell time. A page is
+ *          active while its GetText provider returns true, so a low priority page (for example the robot name) is
+ *          shown until a higher priority one (for example a low battery warning) becomes active. <br>
+ *          An alert set with lcdManagerAlert() preempts the cycle on its line until its duration passes. <br>
+ *          Providers write into a buffer owned by the LCD Manager, so nothing is allocated while cycling.
  *
  * @htmlonly
  * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
@@ -19,34 +22,117 @@
 #include "lcd/LCDManager.h"
 #include "lcd/LCDFunctions.h"
 
-#define NUM_CYCLE_TEXT_DISPLAYS 8
+#define NUM_CYCLE_TEXT_DISPLAYS		8
+#define LCD_MANAGER_DELTAT			100 // Pages are refreshed at this rate while shown so live values update
+#define LCD_MANAGER_MUTEX_TIMEOUT	20
 
 /**
- * @brief Array of cycle text structs for usage on line 1.
+ * @brief The pages, alert, and cycle position of one LCD line
  */
-static DisplayText cycleText_l1[NUM_CYCLE_TEXT_DISPLAYS];
+typedef struct
+{
+	DisplayText pages[NUM_CYCLE_TEXT_DISPLAYS];
+	/**
+	 * @brief Index of the page being shown, -1 if none
+	 */
+	int current;
+	/**
+	 * @brief millis() timestamp at which the current page is replaced by the next one
+	 */
+	unsigned long switchTime;
+	char alert[LCD_MANAGER_TEXT_SIZE];
+	textJustifications alertJustification;
+	/**
+	 * @brief millis() timestamp at which the alert expires, 0 if there is no alert
+	 */
+	unsigned long alertUntil;
+	Mutex mutex;
+} LCDManagerLine;
 
-/**
-* @brief Array of cycle text structs for usage on line 2.
-*/
-static DisplayText cycleText_l2[NUM_CYCLE_TEXT_DISPLAYS];
-static Mutex m_l1, m_l2, m_cT;
+static LCDManagerLine Lines[2];
 static TaskHandle handle;
 
-static void lcdManagerTask()
+/**
+ * @brief Calls the provider of a page
+ *
+ * @returns Returns true if the page is active, in which case buffer contains its text
+ */
+static bool lcdManagerGetText(DisplayText *page, char *buffer)
 {
-	while (true)
+	buffer[0] = '\0';
+	return page->GetText != NULL && page->GetText(buffer, LCD_MANAGER_TEXT_SIZE);
+}
+
+/**
+ * @brief Picks the page to show after the current one: the next active page (in insertion order, wrapping around)
+ *        with the highest priority of any active page on the line.
+ *
+ * @param l
+ *			The line
+ *
+ * @param buffer
+ *			Set to the text of the chosen page
+ *
+ * @returns Returns the index of the chosen page, or -1 if no page is active
+ */
+static int lcdManagerNextPage(LCDManagerLine *l, char *buffer)
+{
+	int best = -1;
+	for (int n = 1; n <= NUM_CYCLE_TEXT_DISPLAYS; n++)
+	{
+		int i = (l->current + n + NUM_CYCLE_TEXT_DISPLAYS) % NUM_CYCLE_TEXT_DISPLAYS;
+		if ((best == -1 || l->pages[i].priority > l->pages[best].priority) && lcdManagerGetText(&l->pages[i], buffer))
+			best = i;
+	}
+	// The provider of the chosen page may not have been the last one called
+	if (best != -1)
+		lcdManagerGetText(&l->pages[best], buffer);
+	return best;
+}
+
+/**
+ * @brief Updates one line of the LCD: shows the alert if there is one, otherwise refreshes the current page or moves
+ *        on to the next one once the dwell time has passed.
+ */
+static void lcdManagerUpdateLine(int line)
+{
+	LCDManagerLine *l = &Lines[line - 1];
+	char buffer[LCD_MANAGER_TEXT_SIZE];
+
+	if (!mutexTake(l->mutex, LCD_MANAGER_MUTEX_TIMEOUT))
+		return;
+
+	unsigned long now = millis();
+	if (l->alertUntil != 0 && now < l->alertUntil)
 	{
-		for (int i = 0; i < NUM_CYCLE_TEXT_DISPLAYS; i++)
+		lcdprint(l->alertJustification, line, l->alert);
+		// Show the cycle from the start of a page once the alert expires
+		l->switchTime = now;
+	}
+	else
+	{
+		l->alertUntil = 0;
+		if (l->current == -1 || now >= l->switchTime || !lcdManagerGetText(&l->pages[l->current], buffer))
 		{
-			//lcdprintf(Centered, 2, "%d / %d", i, NUM_CYCLE_TEXT_DISPLAYS);
-			if (cycleText_l1[i].GetText != NULL)
-				lcdprintf((cycleText_l1[i].GetText)(), cycleText_l1[i].justification, 1);
-			if (cycleText_l2[i].GetText != NULL)
-				lcdprintf((cycleText_l2[i].GetText)(), cycleText_l2[i].justification, 2);
-			delay(100);
+			l->current = lcdManagerNextPage(l, buffer);
+			if (l->current != -1)
+				l->switchTime = now + l->pages[l->current].dwell;
 		}
-		delay(30);
+		if (l->current != -1)
+			lcdprint(l->pages[l->current].justification, line, buffer);
+	}
+
+	mutexGive(l->mutex);
+}
+
+static void lcdManagerTask(void *none)
+{
+	unsigned long wakeTime = millis();
+	while (true)
+	{
+		lcdManagerUpdateLine(1);
+		lcdManagerUpdateLine(2);
+		taskDelayUntil(&wakeTime, LCD_MANAGER_DELTAT);
 	}
 }
 
@@ -56,40 +142,40 @@ static void lcdManagerTask()
 void initLCDManager()
 {
 	lcdInitialize();
-	m_l1 = mutexCreate();
-	m_l2 = mutexCreate();
-	m_cT = mutexCreate();
-	handle = taskCreate(&lcdManagerTask, 85, NULL, 2);
+	for (int i = 0; i < 2; i++)
+	{
+		if (Lines[i].mutex == NULL)
+			Lines[i].mutex = mutexCreate();
+		Lines[i].current = -1;
+	}
+	if (handle == NULL)
+		handle = taskCreate(&lcdManagerTask, TASK_MINIMAL_STACK_SIZE * 2, NULL, TASK_PRIORITY_LOWEST + 1);
 }
 
 /**
- * @brief Adds a cycle text struct to the line in the next available position
+ * @brief Adds a page to the line in the next available position
  *
  * @param text
  *		  Struct to add to LCD Manager
  *
  * @param line
  *		  The LCD line number to display on
+ *
+ * @returns Returns false if the line is invalid or already has NUM_CYCLE_TEXT_DISPLAYS pages
  */
-void addCycleText(DisplayText text, int line)
+bool addCycleText(DisplayText text, int line)
 {
-	if (line < 0 || line > 2) return;
+	if (line < 1 || line > 2 || text.GetText == NULL) return false;
+	LCDManagerLine *l = &Lines[line - 1];
+	if (l->mutex == NULL || !mutexTake(l->mutex, LCD_MANAGER_MUTEX_TIMEOUT)) return false;
+
 	int i = 0;
-	switch (line)
-	{
-		case 1:
-			for (; i < NUM_CYCLE_TEXT_DISPLAYS && cycleText_l1[i].GetText != NULL; i++);
-			if (i > (NUM_CYCLE_TEXT_DISPLAYS - 1)) i = (NUM_CYCLE_TEXT_DISPLAYS - 1);
-			cycleText_l1[i] = text;
-			break;
-		case 2:
-			for (; i < NUM_CYCLE_TEXT_DISPLAYS && cycleText_l2[i].GetText != NULL; i++);
-			if (i > (NUM_CYCLE_TEXT_DISPLAYS - 1)) i = (NUM_CYCLE_TEXT_DISPLAYS - 1);
-			cycleText_l2[i] = text;
-			break;
-		default:
-			break;
-	}
+	for (; i < NUM_CYCLE_TEXT_DISPLAYS && l->pages[i].GetText != NULL; i++);
+	if (i < NUM_CYCLE_TEXT_DISPLAYS)
+		l->pages[i] = text;
+
+	mutexGive(l->mutex);
+	return i < NUM_CYCLE_TEXT_DISPLAYS;
 }
 
 /**
@@ -97,7 +183,7 @@ void addCycleText(DisplayText text, int line)
  *        previously on that location
  *
  * @param text
- *		  Struct to add to LCD Manager
+ *		  Struct to add to LCD Manager. A NULL GetText removes the page.
  *
  * @param line
  *		  The LCD line number to display on
@@ -108,16 +194,47 @@ void addCycleText(DisplayText text, int line)
 void replaceCycleText(DisplayText text, int line, int pos)
 {
 	if (pos < 0 || pos >= NUM_CYCLE_TEXT_DISPLAYS) return;
-	if (line < 0 || line > 2) return;
-	switch (line)
-	{
-		case 1:
-			cycleText_l1[pos] = text;
-			break;
-		case 2:
-			cycleText_l2[pos] = text;
-			break;
-		default:
-			break;
-	}
-}
\ No newline at end of file
+	if (line < 1 || line > 2) return;
+	LCDManagerLine *l = &Lines[line - 1];
+	if (l->mutex == NULL || !mutexTake(l->mutex, LCD_MANAGER_MUTEX_TIMEOUT)) return;
+
+	l->pages[pos] = text;
+	if (l->current == pos)
+		l->switchTime = millis();
+
+	mutexGive(l->mutex);
+}
+
+/**
+ * @brief Shows text on a line for a while, preempting the page cycle. A new alert replaces the previous one.
+ *
+ * @param justification
+ *		  The text justification of the alert
+ *
+ * @param line
+ *		  The LCD line number to display on
+ *
+ * @param duration
+ *		  How long to show the alert in milliseconds
+ *
+ * @param text
+ *		  The text of the alert, copied so it does not have to outlive the call
+ */
+void lcdManagerAlert(textJustifications justification, int line, unsigned long duration, const char *text)
+{
+	if (line < 1 || line > 2) return;
+	LCDManagerLine *l = &Lines[line - 1];
+	if (l->mutex == NULL || !mutexTake(l->mutex, LCD_MANAGER_MUTEX_TIMEOUT)) return;
+
+	int i = 0;
+	for (; i < LCD_MANAGER_TEXT_SIZE - 1 && text[i] != '\0'; i++)
+		l->alert[i] = text[i];
+	l->alert[i] = '\0';
+	l->alertJustification = justification;
+	l->alertUntil = millis() + duration;
+	if (l->alertUntil == 0) l->alertUntil = 1;
+	// Show it now rather than at the next cycle
+	lcdprint(justification, line, l->alert);
+
+	mutexGive(l->mutex);
+}
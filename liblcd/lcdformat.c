@@ -0,0 +1,286 @@
+/**
+ * @file liblcd/lcdformat.c
+ * @author Elliot Berman
+ * @brief Compiled format strings for printers which run every few milliseconds.
+ *
+ * @details vex_sprintf() parses its format string character by character on every call. A format compiled with
+ *          lcdformatCompile() is parsed once into a template of its literal text and a list of fields. <br>
+ *          If every field is a number with a width (e.g. "l:%04d r:%04d"), rendering copies the template and writes
+ *          each number right into its slot. Otherwise, or when a number is wider than its slot, the literal runs
+ *          between slots are copied and the numbers are inserted at their natural width.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#include "main.h"
+#include <stdarg.h>
+#include "lcd/lcdformat.h"
+#include "lcd/vexprintf.h"
+
+#define LCD_FORMAT_NUMBER_SIZE		24 // Enough for a 32 bit whole part, a point, 8 decimals, sign, and terminator
+
+/**
+ * @brief Compiles a format string
+ *
+ * @param format
+ *			The compiled format
+ *
+ * @param string
+ *			The format string. Supports d, u, x, X, q (value and divisor, see vex_sprintf()), c, and s conversions with
+ *			the 0, -, and + flags, a width, and a precision (q only).
+ *
+ * @returns Returns false if the format is too long, has too many fields, or uses an unsupported conversion
+ */
+bool lcdformatCompile(LCDFormat *format, const char *string)
+{
+	int length = 0;
+	format->numFields = 0;
+	format->fixed = true;
+
+	for (; *string != '\0'; string++)
+	{
+		if (*string != '%' || *(string + 1) == '%')
+		{
+			if (length >= LCD_FORMAT_MAX_LENGTH) return false;
+			format->template[length++] = *string;
+			if (*string == '%') string++;
+			continue;
+		}
+
+		if (format->numFields >= LCD_FORMAT_MAX_FIELDS) return false;
+		LCDFormatField *field = &format->fields[format->numFields++];
+		field->flags = 0;
+		field->width = 0;
+		field->decimals = 6;
+
+		string++;
+		for (;; string++)
+		{
+			if (*string == '0') field->flags |= LCD_FORMAT_PAD_ZERO;
+			else if (*string == '-') field->flags |= LCD_FORMAT_PAD_RIGHT;
+			else if (*string == '+') field->flags |= LCD_FORMAT_PLUS;
+			else break;
+		}
+		for (; *string >= '0' && *string <= '9'; string++)
+			field->width = field->width * 10 + (*string - '0');
+		if (*string == '.')
+		{
+			field->decimals = 0;
+			for (string++; *string >= '0' && *string <= '9'; string++)
+				field->decimals = field->decimals * 10 + (*string - '0');
+		}
+		if (*string == 'l') string++;
+
+		switch (*string)
+		{
+			case 'd': case 'u': case 'x': case 'X': case 'q': case 'c':
+				break;
+			case 's':
+				format->fixed = false;
+				break;
+			default:
+				return false;
+		}
+		field->type = *string;
+		if (field->width == 0) format->fixed = false;
+		if (field->decimals > 8) field->decimals = 8;
+
+		// Reserve the slot
+		if (length + field->width > LCD_FORMAT_MAX_LENGTH) return false;
+		field->offset = length;
+		for (int i = 0; i < field->width; i++)
+			format->template[length++] = ' ';
+	}
+
+	format->template[length] = '\0';
+	format->length = length;
+	return true;
+}
+
+/**
+ * @brief Converts one numeric or character argument, building the string backwards from the end of buffer
+ *
+ * @returns Returns a pointer to the start of the string
+ */
+static char *lcdformatNumber(const LCDFormatField *field, va_list *args, char *buffer)
+{
+	char *s = buffer + LCD_FORMAT_NUMBER_SIZE - 1;
+	*s = '\0';
+
+	if (field->type == 'c')
+	{
+		*--s = (char)va_arg(*args, int);
+		return s;
+	}
+
+	int value = va_arg(*args, int);
+	unsigned long base = (field->type == 'x' || field->type == 'X') ? 16 : 10;
+	bool neg = false;
+	unsigned long u = (unsigned long)value, whole, decimals = 0;
+	int digits = 0;
+
+	if ((field->type == 'd' || field->type == 'q') && value < 0)
+	{
+		neg = true;
+		u = 0UL - u;
+	}
+
+	if (field->type == 'q')
+	{
+		int divisor = va_arg(*args, int);
+		if (divisor == 0) divisor = 1;
+		// The same digits as vex_sprintf()
+		neg = vex_fixsplit(value, divisor, field->decimals, &whole, &decimals);
+		digits = field->decimals;
+
+		if (digits > 0)
+		{
+			for (int i = 0; i < digits; i++, decimals /= 10)
+				*--s = '0' + (decimals % 10);
+			*--s = '.';
+		}
+	}
+	else
+		whole = u;
+
+	do
+	{
+		int digit = whole % base;
+		*--s = digit < 10 ? '0' + digit : (field->type == 'X' ? 'A' : 'a') + digit - 10;
+		whole /= base;
+	} while (whole != 0);
+
+	if (neg) *--s = '-';
+	else if (field->flags & LCD_FORMAT_PLUS) *--s = '+';
+	return s;
+}
+
+/**
+ * @brief Writes a converted field padded to width. Zero padding goes between the sign and the digits.
+ *
+ * @returns Returns the number of characters written (limited by space)
+ */
+static int lcdformatPad(const LCDFormatField *field, const char *s, char *out, int space)
+{
+	int length = 0, written = 0;
+	for (const char *c = s; *c != '\0'; c++) length++;
+	int padding = field->width > length ? field->width - length : 0;
+
+	if (field->flags & LCD_FORMAT_PAD_RIGHT)
+	{
+		for (; *s != '\0' && written < space; s++) out[written++] = *s;
+		for (; padding > 0 && written < space; padding--) out[written++] = ' ';
+	}
+	else if ((field->flags & LCD_FORMAT_PAD_ZERO) && field->type != 's' && field->type != 'c')
+	{
+		if ((*s == '-' || *s == '+') && written < space) out[written++] = *s++;
+		for (; padding > 0 && written < space; padding--) out[written++] = '0';
+		for (; *s != '\0' && written < space; s++) out[written++] = *s;
+	}
+	else
+	{
+		for (; padding > 0 && written < space; padding--) out[written++] = ' ';
+		for (; *s != '\0' && written < space; s++) out[written++] = *s;
+	}
+	return written;
+}
+
+/**
+ * @brief Renders a compiled format
+ *
+ * @param format
+ *			The compiled format
+ *
+ * @param out
+ *			The output buffer
+ *
+ * @param size
+ *			The size of out, including the terminator
+ *
+ * @param args
+ *			The arguments, the same as vex_sprintf() would take for the original format string
+ *
+ * @returns Returns the number of characters written, not counting the terminator
+ */
+int lcdformatRenderv(const LCDFormat *format, char *out, unsigned int size, va_list args)
+{
+	if (size == 0) return 0;
+	int space = size - 1;
+	char buffer[LCD_FORMAT_NUMBER_SIZE];
+	va_list copy;
+	va_copy(copy, args);
+
+	if (format->fixed && format->length <= space)
+	{
+		// Fast path: the layout is known, copy the template and drop each number into its slot
+		int i;
+		for (i = 0; i <= format->length; i++)
+			out[i] = format->template[i];
+		for (i = 0; i < format->numFields; i++)
+		{
+			const LCDFormatField *field = &format->fields[i];
+			char *s = lcdformatNumber(field, &copy, buffer);
+			if (buffer + LCD_FORMAT_NUMBER_SIZE - 1 - s > field->width)
+				break; // Does not fit, lay out from scratch below
+			lcdformatPad(field, s, out + field->offset, field->width);
+		}
+		va_end(copy);
+		if (i == format->numFields)
+			return format->length;
+		va_copy(copy, args);
+	}
+
+	int length = 0, literal = 0;
+	for (int i = 0; i <= format->numFields; i++)
+	{
+		int end = (i < format->numFields) ? format->fields[i].offset : format->length;
+		for (; literal < end && length < space; literal++)
+			out[length++] = format->template[literal];
+		if (i == format->numFields) break;
+
+		const LCDFormatField *field = &format->fields[i];
+		const char *s;
+		if (field->type == 's')
+		{
+			s = va_arg(copy, char *);
+			if (s == NULL) s = "(null)";
+		}
+		else
+			s = lcdformatNumber(field, &copy, buffer);
+		length += lcdformatPad(field, s, out + length, space - length);
+		literal = field->offset + field->width;
+	}
+	va_end(copy);
+	out[length] = '\0';
+	return length;
+}
+
+/**
+ * @brief Renders a compiled format
+ *
+ * @param format
+ *			The compiled format
+ *
+ * @param out
+ *			The output buffer
+ *
+ * @param size
+ *			The size of out, including the terminator
+ *
+ * @param ...
+ *			The arguments, the same as vex_sprintf() would take for the original format string
+ *
+ * @returns Returns the number of characters written, not counting the terminator
+ */
+int lcdformatRender(const LCDFormat *format, char *out, unsigned int size, ...)
+{
+	va_list args;
+	va_start(args, size);
+	int length = lcdformatRenderv(format, out, size, args);
+	va_end(args);
+	return length;
+}
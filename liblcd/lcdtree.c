@@ -0,0 +1,315 @@
+/**
+ * @file liblcd/lcdtree.c
+ * @author Elliot Berman
+ * @brief A tree of menus with editable values, driven by the LCD buttons from its own task.
+ *
+ * @details While a menu is open, line 1 shows the title of the selected item and line 2 its value (or what center
+ *          does) between arrows. Left and right move between the items of the current menu, each of which ends with
+ *          a Back (or Exit at the top) item. Center opens a submenu, runs an action, or starts editing a value. <br>
+ *          While editing, left and right change the live variable immediately (holding repeats) and center stops
+ *          editing. <br>
+ *          The menu closes by itself after LCD_TREE_TIMEOUT milliseconds without a button press, and holding center
+ *          for LCD_TREE_OPEN_HOLD milliseconds while it is closed opens the root menu. Nothing here waits on the
+ *          caller, and lcdtreeIsOpen() lets other printers leave the LCD alone while it is in use.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#include "main.h"
+#include "lcd/lcdtree.h"
+#include "lcd/LCDFunctions.h"
+#include "lcd/vexprintf.h"
+
+#define LCD_TREE_TEXT_SIZE		24
+
+static LCDTreeItem *Root;
+/**
+ * @brief Path[i] is the submenu shown at depth i, Index[i] the selected item in it (numChildren is Back/Exit)
+ */
+static LCDTreeItem *Path[LCD_TREE_MAX_DEPTH];
+static unsigned char Index[LCD_TREE_MAX_DEPTH];
+static int Depth;
+static volatile bool Open;
+static bool Editing;
+/**
+ * @brief Set by lcdtreeOpen() and lcdtreeClose(), handled by the menu task so only it touches the navigation state
+ */
+static LCDTreeItem * volatile OpenRequest;
+static volatile bool CloseRequest;
+static TaskHandle lcdtreeTaskHandle;
+
+/**
+ * @brief Writes the value of a leaf into buffer
+ */
+static void lcdtreeFormatValue(LCDTreeItem *item, char *buffer, unsigned int size)
+{
+	switch (item->type)
+	{
+		case LCDTreeInt:
+			vex_snprintf(buffer, size, "%d", *(int *)item->value);
+			break;
+		case LCDTreeDecimal:
+		{
+			double value = *(double *)item->value * item->scale;
+			// vex_snprintf has no * precision, so put the number of decimals in the format
+			char format[8] = "%1.0q";
+			format[3] = '0' + (item->decimals > 8 ? 8 : item->decimals);
+			vex_snprintf(buffer, size, format, (int)(value < 0 ? value - 0.5 : value + 0.5), item->scale);
+			break;
+		}
+		case LCDTreeEnum:
+		{
+			int index = *(int *)item->value - item->min;
+			vex_snprintf(buffer, size, "%s", (index >= 0 && index <= item->max - item->min) ? item->options[index] : "?");
+			break;
+		}
+		case LCDTreeBool:
+			vex_snprintf(buffer, size, "%s", *(bool *)item->value ? "on" : "off");
+			break;
+		case LCDTreeSubmenu:
+			vex_snprintf(buffer, size, "open");
+			break;
+		default:
+			vex_snprintf(buffer, size, "run");
+			break;
+	}
+}
+
+/**
+ * @brief Draws the current menu, or the value being edited
+ */
+static void lcdtreeDraw()
+{
+	char value[LCD_TREE_TEXT_SIZE];
+	char line[LCD_TREE_TEXT_SIZE];
+	LCDTreeItem *menu = Path[Depth];
+
+	if (Index[Depth] >= menu->numChildren)
+	{
+		lcdprint(Centered, 1, Depth == 0 ? "Exit" : "Back");
+		lcdprint(Centered, 2, "<  >");
+		return;
+	}
+
+	LCDTreeItem *item = &menu->children[Index[Depth]];
+	lcdtreeFormatValue(item, value, sizeof(value));
+	if (Editing)
+	{
+		vex_snprintf(line, sizeof(line), "*%s", item->title);
+		lcdprint(Centered, 1, line);
+		vex_snprintf(line, sizeof(line), "- %s +", value);
+	}
+	else
+	{
+		lcdprint(Centered, 1, (char *)item->title);
+		vex_snprintf(line, sizeof(line), "< %s >", value);
+	}
+	lcdprint(Centered, 2, line);
+}
+
+/**
+ * @brief Changes the value of a leaf by one step in the given direction and calls its callback
+ */
+static void lcdtreeStep(LCDTreeItem *item, int direction)
+{
+	switch (item->type)
+	{
+		case LCDTreeInt:
+		{
+			int value = *(int *)item->value + direction * item->step;
+			*(int *)item->value = value > item->max ? item->max : (value < item->min ? item->min : value);
+			break;
+		}
+		case LCDTreeDecimal:
+		{
+			double scaled = *(double *)item->value * item->scale;
+			int value = (int)(scaled < 0 ? scaled - 0.5 : scaled + 0.5) + direction * item->step;
+			value = value > item->max ? item->max : (value < item->min ? item->min : value);
+			*(double *)item->value = (double)value / item->scale;
+			break;
+		}
+		case LCDTreeEnum:
+		{
+			// Wraps around
+			int count = item->max - item->min + 1;
+			int index = (*(int *)item->value - item->min + direction + count) % count;
+			*(int *)item->value = item->min + index;
+			break;
+		}
+		case LCDTreeBool:
+			*(bool *)item->value = !*(bool *)item->value;
+			break;
+		default:
+			return;
+	}
+	if (item->callback != NULL)
+		item->callback(item);
+}
+
+/**
+ * @brief Handles a press (or repeat) of the given LCD button
+ */
+static void lcdtreePress(unsigned int button)
+{
+	LCDTreeItem *menu = Path[Depth];
+	int count = menu->numChildren + 1;
+	LCDTreeItem *item = (Index[Depth] < menu->numChildren) ? &menu->children[Index[Depth]] : NULL;
+
+	if (Editing)
+	{
+		if (button == LCD_BTN_CENTER)
+			Editing = false;
+		else
+			lcdtreeStep(item, button == LCD_BTN_LEFT ? -1 : 1);
+		return;
+	}
+
+	if (button == LCD_BTN_LEFT)
+		Index[Depth] = (Index[Depth] + count - 1) % count;
+	else if (button == LCD_BTN_RIGHT)
+		Index[Depth] = (Index[Depth] + 1) % count;
+	else if (item == NULL)
+	{ // Back or Exit
+		if (Depth == 0)
+			Open = false;
+		else
+			Depth--;
+	}
+	else if (item->type == LCDTreeSubmenu)
+	{
+		if (Depth + 1 < LCD_TREE_MAX_DEPTH && item->numChildren > 0)
+		{
+			Path[++Depth] = item;
+			Index[Depth] = 0;
+		}
+	}
+	else if (item->type == LCDTreeAction)
+	{
+		if (item->callback != NULL)
+			item->callback(item);
+	}
+	else
+		Editing = true;
+}
+
+/**
+ * @brief Polls the LCD buttons and runs the menu. Runs whether or not a menu is open so it can be opened by holding
+ *        center.
+ */
+static void lcdtreeTask(void *none)
+{
+	unsigned long wakeTime = millis(), lastInput = 0, pressTime = 0, lastRepeat = 0;
+	unsigned int previous = 0;
+	while (true)
+	{
+		unsigned int buttons = lcdReadButtons(uart1);
+		unsigned int pressed = buttons & ~previous;
+		unsigned long now = millis();
+		bool redraw = false;
+
+		if (pressed != 0)
+			pressTime = now;
+
+		if (OpenRequest != NULL)
+		{
+			Path[0] = OpenRequest;
+			Index[0] = 0;
+			Depth = 0;
+			Editing = false;
+			Open = true;
+			OpenRequest = NULL;
+			lastInput = now;
+			redraw = true;
+			// Do not treat a button held while opening as a press
+			pressed = 0;
+		}
+		if (CloseRequest)
+		{
+			Open = false;
+			CloseRequest = false;
+		}
+
+		if (!Open)
+		{
+			if (Root != NULL && buttons == LCD_BTN_CENTER && now - pressTime >= LCD_TREE_OPEN_HOLD)
+				OpenRequest = Root; // Center is still held, so it will not count as a press once open
+		}
+		else
+		{
+			unsigned int button = 0;
+			if (pressed & LCD_BTN_LEFT) button = LCD_BTN_LEFT;
+			else if (pressed & LCD_BTN_RIGHT) button = LCD_BTN_RIGHT;
+			else if (pressed & LCD_BTN_CENTER) button = LCD_BTN_CENTER;
+			else if (Editing && (buttons == LCD_BTN_LEFT || buttons == LCD_BTN_RIGHT) &&
+				now - pressTime >= LCD_TREE_REPEAT_DELAY && now - lastRepeat >= LCD_TREE_REPEAT_RATE)
+			{
+				button = buttons;
+				lastRepeat = now;
+			}
+
+			if (button != 0)
+			{
+				lcdtreePress(button);
+				lastInput = now;
+				redraw = true;
+			}
+			if (now - lastInput > LCD_TREE_TIMEOUT)
+				Open = false;
+			if (Open && redraw)
+				lcdtreeDraw();
+			else if (Open && Editing)
+				lcdtreeDraw(); // The value may be changed by others
+		}
+
+		previous = buttons;
+		taskDelayUntil(&wakeTime, LCD_TREE_DELTAT);
+	}
+}
+
+/**
+ * @brief Sets the root menu (opened by holding center) and starts the menu task
+ *
+ * @param root
+ *			A LCDTreeSubmenu item
+ */
+void lcdtreeInitialize(LCDTreeItem *root)
+{
+	Root = root;
+	if (lcdtreeTaskHandle == NULL)
+		lcdtreeTaskHandle = taskCreate(&lcdtreeTask, TASK_MINIMAL_STACK_SIZE * 4, NULL, TASK_PRIORITY_LOWEST + 1);
+}
+
+/**
+ * @brief Opens a menu. Returns immediately, the menu task handles the buttons.
+ *
+ * @param menu
+ *			A LCDTreeSubmenu item; Exit closes the menu from its top level
+ */
+void lcdtreeOpen(LCDTreeItem *menu)
+{
+	if (menu == NULL || menu->type != LCDTreeSubmenu) return;
+	if (lcdtreeTaskHandle == NULL)
+		lcdtreeInitialize(Root);
+	OpenRequest = menu;
+	Open = true;
+}
+
+/**
+ * @brief Closes the menu
+ */
+void lcdtreeClose()
+{
+	CloseRequest = true;
+}
+
+/**
+ * @brief Returns true while a menu is open and owns the LCD
+ */
+bool lcdtreeIsOpen()
+{
+	return Open;
+}
@@ -101,35 +101,39 @@
   -----------------------------------------------------------------------------
                                                                                
      A crippled version for PROS                                               
-     Not thread safe, no printf etc.                                           
+     No printf etc.                                                            
+                                                                               
+     Reentrant: the working variables are a small structure on the caller's    
+     stack, so any number of tasks can format at the same time without a       
+     mutex. One scratch buffer is shared by integer and float conversion.      
+                                                                               
+     %q prints a scaled integer as a fixed point number using only integer     
+     arithmetic, e.g. vex_sprintf(buf, "%1.2qV", millivolts, 1000). It takes   
+     two int arguments, the value and the divisor. %f uses the same            
+     conversion after splitting the double, with 32 bit whole and fractional   
+     parts.                                                                    
                                                                                
   -----------------------------------------------------------------------------
 *//*---------------------------------------------------------------------------*/
 
-// the following should be enough for 32 bit int
+// the following should be enough for 32 bit int and for a fixed point number
+// with a 32 bit whole part and 8 fractional digits
 // it's not enough for a 32 bit binary if we add that later
-#define PRINT_BUF_LEN 16
+#define PRINT_BUF_LEN 24
 
 typedef struct _pdefs {
-    // this need to be the first element so we can easily initialize the structure
-    // with one value
-    int           init;
-
-    // Handle to output buffer
-    char          **out;
+    // Output buffer, advanced as characters are written
+    char          *out;
     
     // flags that determine formatting
     int           use_leading_plus;
     int           max_output_len;
     int           curr_output_len;
 
-    // buffer to assemble output    
+    // buffer to assemble one number, filled from the end
     char          print_buf[PRINT_BUF_LEN];
-    char          float_buf[PRINT_BUF_LEN*2];
 } pdefs;
 
-static  pdefs   pdefs2 = {0};
-
 /*-----------------------------------------------------------------------------*/
 /*  Constants for floating point rounding                                      */
 /*-----------------------------------------------------------------------------*/
@@ -146,31 +150,6 @@ static const double round_nums[8] = {
 } ;
 
 
-/*-----------------------------------------------------------------------------*/
-/** @brief      acquire lock on print variables                                */
-/** @param[in]  p pointer to our working variables, a pdef structure           */
-/*-----------------------------------------------------------------------------*/
-
-inline void
-vex_print_acquire( pdefs *p )
-{
-    if(!p->init)
-        {
-        p->init = 1;
-        }
- }
-
-/*-----------------------------------------------------------------------------*/
-/** @brief      release lock on print variables                                */
-/** @param[in]  p pointer to our working variables, a pdef structure           */
-/*-----------------------------------------------------------------------------*/
-
-inline void
-vex_print_release( pdefs *p )
-{
-    (void)p;
-}
-
 /*-----------------------------------------------------------------------------*/
 /** @brief      move one character to output                                   */
 /** @param[in]  p pointer to our working variables, a pdef structure           */
@@ -191,8 +170,7 @@ vex_printc ( pdefs *p, int c )
 
     // is output buffer NULL ?
     if (p->out) {
-        **p->out = (char) c;
-        ++(*p->out);
+        *p->out++ = (char) c;
         p->curr_output_len++ ;
     }
 }
@@ -274,7 +252,7 @@ vex_printi ( pdefs *p, int i, uint16_t base, int sign, int width, int pad, int l
         u = (unsigned) -i;
         }
     //  make sure print_buf is NULL-term
-    s = p->print_buf + PRINT_BUF_LEN - 1;
+    s = p->print_buf + sizeof(p->print_buf) - 1;
     *s = '\0';
 
     while (u)
@@ -309,97 +287,214 @@ vex_printi ( pdefs *p, int i, uint16_t base, int sign, int width, int pad, int l
     return pc + vex_prints ( p, s, width, pad );
 }
 
+/*-----------------------------------------------------------------------------*/
+/** @brief      move a converted number into the output buffer with padding    */
+/** @param[in]  p pointer to our working variables, a pdef structure           */
+/** @param[in]  string the number, possibly with a leading sign               */
+/** @param[in]  width required output width                                    */
+/** @param[in]  pad type of padding, left, right, zeros                        */
+/** @returns    the number of characters that were output                      */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Zero padding goes between the sign and the digits, as in vex_printi
+ */
+static int
+vex_printnum ( pdefs *p, const char *string, int width, int pad )
+{
+    int pc = 0;
+
+    if (width && (pad & PAD_ZERO) && (*string == '-' || *string == '+'))
+        {
+        vex_printc ( p, *string++ );
+        ++pc;
+        --width;
+        }
+
+    return pc + vex_prints ( p, string, width, pad );
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      split a scaled integer into whole and fractional parts         */
+/** @param[in]  value the scaled value                                         */
+/** @param[in]  divisor value / divisor is split, must not be 0                */
+/** @param[in]  dec_digits number of fractional digits, at most 8              */
+/** @param[out] wholeNum integer part                                          */
+/** @param[out] decimalNum fractional part, scaled to dec_digits               */
+/** @returns    1 if the number is negative (never for -0.00), else 0          */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Integer only, fractional digits are produced one at a time by long
+ *  division of the remainder and the last one is rounded half up. Shared
+ *  by %q here and in lcdformat so both print the same digits.
+ */
+int
+vex_fixsplit( int value, int divisor, unsigned dec_digits, unsigned long *wholeNum, unsigned long *decimalNum )
+{
+    int neg = 0;
+    unsigned idx;
+
+    unsigned long u = (unsigned long) value;
+    if (value < 0) {
+        neg = 1;
+        u = 0UL - u;
+    }
+    if (divisor < 0) {
+        divisor = -divisor;
+        neg = !neg;
+    }
+
+    unsigned long whole = u / (unsigned long) divisor;
+    unsigned long rem = u % (unsigned long) divisor;
+    unsigned long decimal = 0, mult = 1;
+
+    for (idx = 0; idx < dec_digits; idx++) {
+        rem *= 10;
+        decimal = decimal * 10 + rem / (unsigned long) divisor;
+        rem %= (unsigned long) divisor;
+        mult *= 10;
+    }
+
+    // round half up, carrying into the whole part
+    if (rem * 2 >= (unsigned long) divisor) {
+        if (++decimal >= mult) {
+            decimal = 0;
+            whole++;
+        }
+    }
+
+    // don't print -0.00
+    if (whole == 0 && decimal == 0)
+        neg = 0;
+
+    *wholeNum = whole;
+    *decimalNum = decimal;
+    return neg;
+}
+
+/*-----------------------------------------------------------------------------*/
+/** @brief      convert a split fixed point number to ascii representation     */
+/** @param[in]  p pointer to our working variables, a pdef structure           */
+/** @param[in]  neg non zero if the number is negative                         */
+/** @param[in]  wholeNum integer part                                          */
+/** @param[in]  decimalNum fractional part, already scaled to dec_digits       */
+/** @param[in]  dec_digits number of fractional digits                         */
+/** @returns    pointer to the start of the string in print_buf                */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  The string is built backwards from the end of print_buf so no second
+ *  buffer is needed to reverse the digits
+ */
+static char *
+fix2stri( pdefs *p, int neg, unsigned long wholeNum, unsigned long decimalNum, unsigned dec_digits )
+{
+    char *output = p->print_buf + PRINT_BUF_LEN - 1;
+    unsigned idx;
+
+    // terminating null
+    *output = 0 ;
+
+    // convert fractional part if necessary, padded with 0s
+    // We wouldn't want to report 3.093 as 3.93, would we??
+    if (dec_digits > 0)
+        {
+        for (idx = 0; idx < dec_digits; idx++) {
+            *--output = '0' + (decimalNum % 10) ;
+            decimalNum /= 10 ;
+        }
+        *--output = '.' ;
+        }
+
+    // convert integer portion
+    do {
+        *--output = '0' + (wholeNum % 10) ;
+        wholeNum /= 10 ;
+    } while (wholeNum != 0);
+
+    if (neg)
+        *--output = '-' ;
+    else
+    if (p->use_leading_plus)
+        *--output = '+' ;
+
+    return output;
+}
+
 /*-----------------------------------------------------------------------------*/
 /** @brief      convert one double to ascii representation                     */
 /** @param[in]  p pointer to our working variables, a pdef structure           */
 /** @param[in]  dbl input value                                                */
 /** @param[in]  dec_width required number of fractional digits                 */
+/** @returns    pointer to the start of the string in print_buf                */
 /*-----------------------------------------------------------------------------*/
 /** @details
  *  This function converts one double to a string
  *  it's declared inline as it is only called from vex_printdbl
  */
-static inline void
+static inline char *
 dbl2stri( pdefs *p, double dbl, unsigned dec_digits )
 {
-    char *output = p->float_buf;
-        
+    int neg = 0;
+    unsigned idx ;
+
     //  extract negative info
     if (dbl < 0.0) {
-        *output++ = '-' ;
+        neg = 1;
         dbl *= -1.0 ;
-    } else {
-        if (p->use_leading_plus) {
-            *output++ = '+' ;
-        }
     }
 
+    // more digits than this do not fit in 32 bits
+    if (dec_digits > 8)
+        dec_digits = 8;
+
     //  handling rounding by adding .5LSB to the floating-point data
-    if (dec_digits < 8) {
+    if (dec_digits < 8)
         dbl += round_nums[dec_digits] ;
-    }
 
     //  construct fractional multiplier for specified number of digits.
-    uint16_t mult = 1 ;
-    uint16_t idx ;
+    unsigned long mult = 1 ;
     for (idx=0; idx < dec_digits; idx++)
         mult *= 10 ;
 
-    uint16_t wholeNum   = (uint16_t) dbl ;
-    uint16_t decimalNum = (uint16_t) ((dbl - wholeNum) * mult);
+    // saturate rather than wrap around
+    unsigned long wholeNum   = dbl < 4294967295.0 ? (unsigned long) dbl : 4294967295UL ;
+    unsigned long decimalNum = (unsigned long) ((dbl - wholeNum) * mult);
+    if (decimalNum >= mult)
+        decimalNum = mult - 1;
 
-    // convert integer portion
-    // this creates the number in reverse in print_buf
-    idx = 0 ;
-    while (wholeNum != 0) {
-        p->print_buf[idx++] = '0' + (wholeNum % 10) ;
-        wholeNum /= 10 ;
-    }
+    // don't print -0.00, as vex_printfix does not
+    if (wholeNum == 0 && decimalNum == 0)
+        neg = 0;
 
-    // move integer part to output buffer
-    if (idx == 0) {
-        *output++ = '0' ;
-    } else {
-        while (idx > 0) {
-            *output++ = p->print_buf[idx-1] ;  //lint !e771
-            idx-- ;
-        }
-    }
-    
-    // convert fractional part if necessary
-    if (dec_digits > 0)
-        {
-        *output++ = '.' ;
+    return fix2stri( p, neg, wholeNum, decimalNum, dec_digits );
+}
 
-        // convert fractional portion
-        // this creates the number in reverse in print_buf
-        idx = 0 ;
-        while (decimalNum != 0) {
-            p->print_buf[idx++] = '0' + (decimalNum % 10) ;
-            decimalNum /= 10 ;
-        }
-        
-        //  pad the decimal portion with 0s as necessary;
-        //  We wouldn't want to report 3.093 as 3.93, would we??
-        while (idx < dec_digits) {
-            p->print_buf[idx++] = '0' ;
-        }
+/*-----------------------------------------------------------------------------*/
+/** @brief      convert one scaled integer to formatted fixed point output     */
+/** @param[in]  p pointer to our working variables, a pdef structure           */
+/** @param[in]  value the scaled value                                         */
+/** @param[in]  divisor value / divisor is printed, e.g. 1000 for milli units  */
+/** @param[in]  width required output width                                    */
+/** @param[in]  dec_digits required number of fractional digits                */
+/** @param[in]  pad type of padding, left, right, zeros                        */
+/** @returns    the number of characters that were output                      */
+/*-----------------------------------------------------------------------------*/
+/** @details
+ *  Integer only, see vex_fixsplit
+ */
+static int
+vex_printfix( pdefs *p, int value, int divisor, int width, unsigned dec_digits, int pad )
+{
+    unsigned long wholeNum, decimalNum;
+    int neg;
 
-        // move fractional part to output buffer
-        if (idx == 0) {
-            *output++ = '0' ;
-        } else {
-            while (idx > 0) {
-                *output++ = p->print_buf[idx-1] ;
-                idx-- ;
-            }
-        }
-    }
-    
-    // terminating null
-    *output = 0 ;
+    if (divisor == 0)
+        return vex_prints ( p, "inf", width, pad );
 
-    return;
+    if (dec_digits > 8)
+        dec_digits = 8;
+
+    neg = vex_fixsplit( value, divisor, dec_digits, &wholeNum, &decimalNum );
+    return vex_printnum ( p, fix2stri( p, neg, wholeNum, decimalNum, dec_digits ), width, pad );
 }
 
 /*-----------------------------------------------------------------------------*/
@@ -417,9 +512,7 @@ dbl2stri( pdefs *p, double dbl, unsigned dec_digits )
 static inline int
 vex_printdbl( pdefs *p, double dbl, int width, int dec_digits, int pad )
 {
-    dbl2stri( p, dbl, dec_digits ) ;
-    
-    return vex_prints ( p, p->float_buf, width, pad );
+    return vex_printnum ( p, dbl2stri( p, dbl, dec_digits ), width, pad );
 }
 
 /*-----------------------------------------------------------------------------*/
@@ -509,7 +602,7 @@ vex_print( pdefs *p, const char *format, va_list args )
                 {
                 case 's':
                     {
-                    char *s = (char *)va_arg( args, int );
+                    char *s = va_arg( args, char * );
                     pc += vex_prints ( p, s ? s : "(null)", width, pad );
                     p->use_leading_plus = 0 ;  //  reset this flag after printing one value
                     }
@@ -541,7 +634,15 @@ vex_print( pdefs *p, const char *format, va_list args )
 
                 case 'f':
                     {
-                    vex_printdbl(p, va_arg( args, double ), width, dec_width, pad ) ;
+                    pc += vex_printdbl(p, va_arg( args, double ), width, dec_width, pad ) ;
+                    p->use_leading_plus = 0 ;  //  reset this flag after printing one value
+                    }
+                    break;
+
+                case 'q':
+                    {
+                    int value = va_arg( args, int );
+                    pc += vex_printfix(p, value, va_arg( args, int ), width, dec_width, pad ) ;
                     p->use_leading_plus = 0 ;  //  reset this flag after printing one value
                     }
                     break;
@@ -561,11 +662,9 @@ vex_print( pdefs *p, const char *format, va_list args )
             }
         }  //  for each char in format string
 
+    // there is always room for the terminator, max_output_len excludes it
     if (p->out)
-        **p->out = '\0';
-
-    // release mutex/semaphore
-    vex_print_release(p);
+        *p->out = '\0';
 
     return pc;
 }
@@ -582,45 +681,35 @@ vex_print( pdefs *p, const char *format, va_list args )
  */
 int vex_sprintf (char *out, const char *format, ...)
 {
+    int pc;
     va_list args;
 
-    vex_print_acquire(&pdefs2);
-
-    pdefs2.out = &out;
-    pdefs2.max_output_len = -1 ;
-
     va_start( args, format );
-    return vex_print( &pdefs2, format, args );
+    pc = vex_vsprintf( out, format, args );
+    va_end( args );
+
+    return pc;
 }
 
 /*-----------------------------------------------------------------------------*/
 /** @brief      create formated string in a buffer                             */
 /** @param[out] out The output buffer                                          */
-/** @param[out] max_len The output buffer length                               */
+/** @param[out] max_len The output buffer length, including the terminator     */
 /** @param[in]  format The format string                                       */
 /** @returns    the number of characters that were output                      */
 /*-----------------------------------------------------------------------------*/
 /** @details
  *  This has similar but reduced functionality to the standard library function
- *  sprintf
+ *  snprintf
  */
 int vex_snprintf(char *out, uint16_t max_len, const char *format, ...)
 {
     int pc;
-
     va_list args;
 
-    vex_print_acquire(&pdefs2);
-
-    pdefs2.out = &out;
-    pdefs2.max_output_len = (int) max_len ;
-
     va_start( args, format );
-
-    pc = vex_print( &pdefs2, format, args );
-
-    // maximum will have been limited to max)len
-    if(pc > max_len) pc = max_len;
+    pc = vex_vsnprintf( out, max_len, format, args );
+    va_end( args );
 
     return pc;
 }
@@ -638,39 +727,38 @@ int vex_snprintf(char *out, uint16_t max_len, const char *format, ...)
  */
 int vex_vsprintf( char *out, const char *format, va_list args )
 {
-    vex_print_acquire(&pdefs2);
+    pdefs p;
 
-    pdefs2.out = &out;
-    pdefs2.max_output_len = -1 ;
+    p.out = out;
+    p.max_output_len = -1 ;
 
-    return vex_print( &pdefs2, format, args );
+    return vex_print( &p, format, args );
 }
 
 /*-----------------------------------------------------------------------------*/
 /** @brief      create formated string in a buffer from a va_list              */
 /** @param[out] out The output buffer                                          */
-/** @param[out] max_len The output buffer length                               */
+/** @param[out] max_len The output buffer length, including the terminator     */
 /** @param[in]  format The format string                                       */
 /** @param[in]  args a variable argument list                                  */
 /** @returns    the number of characters that were output                      */
 /*-----------------------------------------------------------------------------*/
 /** @details
  *  This has similar but reduced functionality to the standard library function
- *  sprintf
+ *  vsnprintf. At most max_len - 1 characters are written, followed by a
+ *  terminating null.
  */
 int vex_vsnprintf(char *out, uint16_t max_len, const char *format, va_list args )
 {
-    int pc;
+    pdefs p;
 
-    vex_print_acquire(&pdefs2);
+    if (max_len == 0)
+        return 0;
 
-    pdefs2.out = &out;
-    pdefs2.max_output_len = (int) max_len ;
+    p.out = out;
+    p.max_output_len = (int) max_len - 1 ;
 
-    pc = vex_print( &pdefs2, format, args );
+    vex_print( &p, format, args );
 
-    // maximum will have been limited to max)len
-    if(pc > max_len) pc = max_len;
-
-    return pc;
+    return p.curr_output_len;
 }
@@ -0,0 +1,192 @@
+/**
+ * @file libsml/CommandScheduler.c
+ * @author Elliot Berman
+ * @brief Runs autonomous commands, alone or in sequential, parallel, race, and deadline groups, from one task.
+ *
+ * @details A routine builds a tree of commands and runs its root with CommandRun(), which polls the whole tree every
+ *          COMMAND_SCHEDULER_DELTAT milliseconds from the calling task. Commands never block: each poll does a bit of
+ *          work and returns, so a lift move and a chassis move in a parallel group progress together instead of one
+ *          after the other. <br>
+ *          A command that is interrupted (by a race or deadline group, or its timeout) has End called with true so
+ *          it can stop its motors.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#include "main.h"
+#include "sml/CommandScheduler.h"
+
+static void (*Observer)(Command *, bool);
+
+/**
+ * @brief Sets a function called as every CommandBasic starts (with false) and as it finishes or is interrupted (with
+ *        true), e.g. to profile a routine
+ *
+ * @param observer
+ *			The function, NULL for none
+ */
+void CommandSetObserver(void (*observer)(Command *, bool))
+{
+	Observer = observer;
+}
+
+/**
+ * @brief Starts a command (and the children which start with it)
+ */
+void CommandStart(Command *command)
+{
+	command->started = true;
+	command->finished = false;
+	command->interrupted = false;
+	command->index = 0;
+	command->count = 0;
+	command->startTime = millis();
+
+	switch (command->type)
+	{
+		case CommandBasic:
+			if (Observer != NULL)
+				Observer(command, false);
+			if (command->Initialize != NULL)
+				command->Initialize(command);
+			break;
+		case CommandSequential:
+			if (command->numChildren > 0)
+				CommandStart(command->children[0]);
+			break;
+		default:
+			for (int i = 0; i < command->numChildren; i++)
+				CommandStart(command->children[i]);
+			break;
+	}
+}
+
+/**
+ * @brief Stops a running command before it has finished. Does nothing to commands which have not started or have
+ *        finished.
+ */
+void CommandInterrupt(Command *command)
+{
+	if (!command->started || command->finished)
+		return;
+	if (command->type == CommandBasic)
+	{
+		if (command->End != NULL)
+			command->End(command, true);
+		if (Observer != NULL)
+			Observer(command, true);
+	}
+	else
+	{
+		for (int i = 0; i < command->numChildren; i++)
+			CommandInterrupt(command->children[i]);
+	}
+	command->finished = true;
+	command->interrupted = true;
+}
+
+/**
+ * @brief Interrupts the children of a group that are still running
+ */
+static void commandInterruptChildren(Command *command)
+{
+	for (int i = 0; i < command->numChildren; i++)
+		CommandInterrupt(command->children[i]);
+}
+
+/**
+ * @brief Does one poll of a started command
+ *
+ * @returns Returns true once the command has finished
+ */
+bool CommandPoll(Command *command)
+{
+	if (command->finished)
+		return true;
+
+	bool done = false;
+	switch (command->type)
+	{
+		case CommandBasic:
+			done = (command->Execute == NULL || command->Execute(command));
+			if (done && command->End != NULL)
+				command->End(command, false);
+			if (done && Observer != NULL)
+				Observer(command, true);
+			break;
+		case CommandSequential:
+			// The next child starts in the same poll the previous one finished in
+			while (command->index < command->numChildren && CommandPoll(command->children[command->index]))
+			{
+				command->index++;
+				if (command->index < command->numChildren)
+					CommandStart(command->children[command->index]);
+			}
+			done = (command->index >= command->numChildren);
+			break;
+		case CommandParallel:
+			done = true;
+			for (int i = 0; i < command->numChildren; i++)
+				if (!CommandPoll(command->children[i]))
+					done = false;
+			break;
+		case CommandRace:
+			for (int i = 0; i < command->numChildren; i++)
+				if (CommandPoll(command->children[i]))
+					done = true;
+			if (done)
+				commandInterruptChildren(command);
+			break;
+		case CommandDeadline:
+			for (int i = 0; i < command->numChildren; i++)
+				CommandPoll(command->children[i]);
+			done = (command->numChildren == 0 || command->children[0]->finished);
+			if (done)
+				commandInterruptChildren(command);
+			break;
+	}
+
+	if (!done && command->timeout != 0 && millis() - command->startTime >= command->timeout)
+	{
+		CommandInterrupt(command);
+		return true;
+	}
+	command->finished = done;
+	return done;
+}
+
+/**
+ * @brief Runs a command to completion, polling it every COMMAND_SCHEDULER_DELTAT milliseconds from the calling task
+ *
+ * @returns Returns false if the command was cut short by its timeout
+ */
+bool CommandRun(Command *command)
+{
+	unsigned long wakeTime = millis();
+	CommandStart(command);
+	while (!CommandPoll(command))
+		taskDelayUntil(&wakeTime, COMMAND_SCHEDULER_DELTAT);
+	return !command->interrupted;
+}
+
+static bool commandWaitExecute(Command *command)
+{
+	return millis() - command->startTime >= (unsigned long)command->args[0];
+}
+
+/**
+ * @brief Returns a command which does nothing for a while
+ *
+ * @param duration
+ *			Milliseconds to wait
+ */
+Command CommandWait(unsigned long duration)
+{
+	Command command = { .type = CommandBasic, .Execute = &commandWaitExecute, .args = { (int)duration },
+		.name = "wait" };
+	return command;
+}
@@ -0,0 +1,221 @@
+/**
+ * @file libsml/EncoderVelocity.c
+ * @author Elliot Berman
+ * @brief Quadrature encoder driver which timestamps every edge with micros() to estimate velocity.
+ *
+ * @details Finite differences of encoderGet() at the control rate are very coarse when the mechanism moves
+ * slowly: at 15 ms and a handful of ticks per window, one tick of quantization is a large fraction of the speed.
+ * This driver decodes the quadrature signal itself from pin change interrupts (PROS does not allow
+ * ioSetInterrupt() on pins owned by the built-in encoder driver) and records when each edge happened. <br>
+ * <br>
+ * Velocity is estimated in one of two ways:
+ *		- Count-based: ticks elapsed over the sample window, used when there are enough edges in the window
+ *		  that quantization is small.
+ *		- Period-based: the time between the two most recent edges, used at low speed where only zero or one
+ *		  edge happens per window. If no edge has happened for longer than the last period, the time since the
+ *		  last edge is used instead so the estimate decays to zero when the mechanism stops.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************/
+
+#include "main.h"
+#include "sml/EncoderVelocity.h"
+
+static EncoderVelocity Encoders[ENCODER_VELOCITY_MAX_ENCODERS];
+static EncoderVelocity *PinMap[BOARD_NR_GPIO_PINS];
+
+/**
+ * @brief Tick delta for a transition from the previous quadrature state (high 2 bits) to the current state (low 2 bits).
+ *        Invalid transitions (both channels changed) count as 0.
+ */
+static const signed char QuadratureTable[16] = { 0, 1, -1, 0, -1, 0, 0, 1, 1, 0, 0, -1, 0, -1, 1, 0 };
+
+/**
+ * @brief Reads the current 2-bit quadrature state of an encoder
+ */
+static unsigned char encoderVelocityReadState(EncoderVelocity *enc)
+{
+	return (digitalRead(enc->portTop) ? 2 : 0) | (digitalRead(enc->portBottom) ? 1 : 0);
+}
+
+/**
+ * @brief Pin change interrupt handler for both channels of every encoder. Runs in an ISR, so keep it short.
+ *
+ * @param pin
+ *			The pin that changed
+ */
+static void encoderVelocityHandler(unsigned char pin)
+{
+	EncoderVelocity *enc = PinMap[pin];
+	if (enc == NULL) return;
+
+	unsigned long now = micros();
+	unsigned char state = encoderVelocityReadState(enc);
+	int step = QuadratureTable[(enc->state << 2) | state] * enc->direction;
+	enc->state = state;
+	if (step == 0) return;
+
+	enc->count += step;
+	enc->period = (step == enc->lastStep) ? now - enc->lastEdge : 0;
+	enc->lastStep = step;
+	enc->lastEdge = now;
+	enc->sequence++;
+}
+
+/**
+ * @brief Initializes a quadrature encoder on the two given ports and enables pin change interrupts on both.
+ *
+ * @param portTop
+ *			The digital port of the "top" wire [1,9] or [11,12]
+ *
+ * @param portBottom
+ *			The digital port of the "bottom" wire [1,9] or [11,12]
+ *
+ * @param reverse
+ *			Flips the direction of counting, same as encoderInit()
+ *
+ * @returns Returns a pointer to the encoder, or NULL if the ports are invalid or no encoders are left
+ *
+ * @warning Do not also call encoderInit() on the same ports.
+ */
+EncoderVelocity *EncoderVelocityInit(unsigned char portTop, unsigned char portBottom, bool reverse)
+{
+	if (portTop == 0 || portTop >= BOARD_NR_GPIO_PINS || portTop == 10 ||
+		portBottom == 0 || portBottom >= BOARD_NR_GPIO_PINS || portBottom == 10)
+		return NULL;
+
+	EncoderVelocity *enc = NULL;
+	for (int i = 0; i < ENCODER_VELOCITY_MAX_ENCODERS && enc == NULL; i++)
+		if (Encoders[i].portTop == 0)
+			enc = &Encoders[i];
+	if (enc == NULL) return NULL;
+
+	enc->portTop = portTop;
+	enc->portBottom = portBottom;
+	enc->direction = reverse ? -1 : 1;
+	enc->count = 0;
+	enc->offset = 0;
+	enc->lastStep = 0;
+	enc->period = 0;
+	enc->sequence = 0;
+	enc->sampleCount = 0;
+	enc->velocity = 0;
+
+	pinMode(portTop, INPUT);
+	pinMode(portBottom, INPUT);
+	enc->state = encoderVelocityReadState(enc);
+	enc->lastEdge = micros();
+	enc->sampleTime = enc->lastEdge;
+
+	PinMap[portTop] = enc;
+	PinMap[portBottom] = enc;
+	ioSetInterrupt(portTop, INTERRUPT_EDGE_BOTH, &encoderVelocityHandler);
+	ioSetInterrupt(portBottom, INTERRUPT_EDGE_BOTH, &encoderVelocityHandler);
+
+	return enc;
+}
+
+/**
+ * @brief Disables the interrupts of an encoder and frees it for reuse
+ *
+ * @param enc
+ *			A pointer to the encoder
+ */
+void EncoderVelocityShutdown(EncoderVelocity *enc)
+{
+	if (enc == NULL || enc->portTop == 0) return;
+
+	ioClearInterrupt(enc->portTop);
+	ioClearInterrupt(enc->portBottom);
+	PinMap[enc->portTop] = NULL;
+	PinMap[enc->portBottom] = NULL;
+	enc->portTop = 0;
+}
+
+/**
+ * @brief Returns the number of ticks counted since the last reset. Same units as encoderGet()
+ *
+ * @param enc
+ *			A pointer to the encoder
+ */
+int EncoderVelocityGetCount(EncoderVelocity *enc)
+{
+	if (enc == NULL) return 0;
+	return enc->count - enc->offset;
+}
+
+/**
+ * @brief Resets the tick count to 0. The velocity estimate is not affected.
+ *
+ * @param enc
+ *			A pointer to the encoder
+ */
+void EncoderVelocityReset(EncoderVelocity *enc)
+{
+	if (enc == NULL) return;
+
+	// The interrupt handler owns count, so remember where zero is instead of writing to it
+	enc->offset = enc->count;
+}
+
+/**
+ * @brief Returns ticks multiplied by 1000000 and divided by microseconds without overflowing a long
+ */
+static int encoderVelocityTicksPerSecond(int ticks, unsigned long us)
+{
+	if (us == 0) return 0;
+	if (abs(ticks) < 2000)
+		return (int)((ticks * 1000000L) / (long)us);
+	return (int)((ticks * 1000L) / (long)(us / 1000 + 1));
+}
+
+/**
+ * @brief Returns the estimated velocity of the encoder in ticks per second and publishes it to enc->velocity.
+ *        If called again within ENCODER_VELOCITY_MIN_WINDOW microseconds, the previously published value is returned
+ *        so several controllers can read the same encoder without shrinking each other's sample windows.
+ *
+ * @param enc
+ *			A pointer to the encoder
+ *
+ * @returns Returns the velocity in ticks per second (positive when the count is increasing)
+ */
+int EncoderVelocityGet(EncoderVelocity *enc)
+{
+	if (enc == NULL) return 0;
+
+	unsigned long now = micros();
+	if (now - enc->sampleTime < ENCODER_VELOCITY_MIN_WINDOW)
+		return enc->velocity;
+
+	// Take a consistent snapshot of the values written by the interrupt handler
+	unsigned int sequence;
+	int count, lastStep;
+	unsigned long lastEdge, period;
+	do
+	{
+		sequence = enc->sequence;
+		count = enc->count;
+		lastStep = enc->lastStep;
+		lastEdge = enc->lastEdge;
+		period = enc->period;
+		now = micros();
+	} while (sequence != enc->sequence);
+
+	int deltaCount = count - enc->sampleCount;
+	unsigned long sinceEdge = now - lastEdge;
+
+	if (abs(deltaCount) >= ENCODER_VELOCITY_COUNT_THRESHOLD)
+		enc->velocity = encoderVelocityTicksPerSecond(deltaCount, now - enc->sampleTime);
+	else if (period == 0 || sinceEdge > ENCODER_VELOCITY_TIMEOUT)
+		enc->velocity = 0;
+	else
+		enc->velocity = encoderVelocityTicksPerSecond(lastStep, sinceEdge > period ? sinceEdge : period);
+
+	enc->sampleCount = count;
+	enc->sampleTime = now;
+	return enc->velocity;
+}
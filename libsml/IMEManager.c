@@ -0,0 +1,273 @@
+/**
+ * @file libsml/IMEManager.c
+ * @author Elliot Berman
+ * @brief Wraps the PROS IME functions with error tracking, retries, backoff and bus recovery.
+ *
+ * @details imeGet() leaves its output undefined when the read fails, so a flaky I2C cable feeds garbage into
+ * any controller reading it directly. Every read made through the IME Manager instead: <br>
+ *		- is retried up to IME_MANAGER_RETRIES times, and its latency is recorded
+ *		- on failure returns the last good value and backs the device off (doubling up to IME_MANAGER_BACKOFF_MAX)
+ *		  so a dead device does not cost a bus timeout every control loop
+ *		- marks the device degraded after IME_MANAGER_DEGRADED_ERRORS failures in a row
+ *
+ * A low priority task shuts the chain down and re-runs imeInitializeAll() while any device is degraded.
+ * Counts are lost when the chain is re-initialized, so an offset keeps the reported count continuous.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************/
+
+#include "main.h"
+#include "sml/IMEManager.h"
+
+static IMEDevice Devices[IME_MANAGER_MAX_DEVICES];
+static unsigned char NumDevices;
+static unsigned int BusResets;
+static unsigned long LastBusReset;
+static volatile bool Resetting;
+static Mutex BusMutex;
+static TaskHandle IMEManagerTaskHandle;
+
+/**
+ * @brief Marks every device at or above the given address as missing from the chain
+ *
+ * @param found
+ *			The number of IMEs that imeInitializeAll() found
+ */
+static void imeManagerMarkMissing(unsigned int found)
+{
+	for (unsigned int i = 0; i < NumDevices; i++)
+	{
+		Devices[i].degraded = (i >= found);
+		Devices[i].consecutiveErrors = (i >= found) ? IME_MANAGER_DEGRADED_ERRORS : 0;
+		Devices[i].backoff = 0;
+		Devices[i].backoffUntil = 0;
+	}
+}
+
+/**
+ * @brief Shuts down and re-initializes the IME chain. Counts restart at zero, so every device's offset is set to
+ *        its last good value.
+ */
+static void imeManagerResetBus()
+{
+	if (!mutexTake(BusMutex, IME_MANAGER_MUTEX_TIMEOUT))
+		return;
+	Resetting = true;
+
+	imeShutdown();
+	delay(IME_MANAGER_RESET_DELAY);
+	unsigned int found = imeInitializeAll();
+	for (unsigned int i = 0; i < NumDevices; i++)
+		Devices[i].offset = Devices[i].lastValue;
+	imeManagerMarkMissing(found);
+
+	BusResets++;
+	LastBusReset = millis();
+	Resetting = false;
+	mutexGive(BusMutex);
+}
+
+/**
+ * @brief Resets the bus whenever a device is degraded, at most once every IME_MANAGER_RESET_INTERVAL milliseconds
+ */
+static void IMEManagerTask(void *none)
+{
+	while (true)
+	{
+		bool degraded = false;
+		for (unsigned char i = 0; i < NumDevices; i++)
+			degraded |= Devices[i].degraded;
+
+		if (degraded && millis() - LastBusReset > IME_MANAGER_RESET_INTERVAL)
+			imeManagerResetBus();
+
+		delay(IME_MANAGER_TASK_DELTAT);
+	}
+}
+
+/**
+ * @brief Initializes the IME chain with imeInitializeAll() and starts the IME Manager task
+ *
+ * @param count
+ *			The number of IMEs expected on the chain. Any that are not found are marked degraded.
+ *
+ * @returns Returns the number of IMEs imeInitializeAll() found
+ */
+unsigned int IMEManagerInitialize(unsigned char count)
+{
+	if (count > IME_MANAGER_MAX_DEVICES)
+		count = IME_MANAGER_MAX_DEVICES;
+	NumDevices = count;
+
+	if (BusMutex == NULL)
+		BusMutex = mutexCreate();
+
+	unsigned int found = imeInitializeAll();
+	imeManagerMarkMissing(found);
+	LastBusReset = millis();
+
+	if (IMEManagerTaskHandle == NULL)
+		IMEManagerTaskHandle = taskCreate(IMEManagerTask, TASK_MINIMAL_STACK_SIZE * 2, NULL, TASK_PRIORITY_LOWEST + 1);
+	return found;
+}
+
+/**
+ * @brief Performs one bus read with retries, backoff, and bookkeeping
+ *
+ * @param address
+ *			The IME address
+ *
+ * @param read
+ *			imeGet or imeGetVelocity
+ *
+ * @param value
+ *			Set to the raw value on success
+ *
+ * @returns Returns true if the read succeeded
+ */
+static bool imeManagerRead(unsigned char address, bool (*read)(unsigned char, int *), int *value)
+{
+	if (address >= NumDevices || Resetting)
+		return false;
+
+	IMEDevice *device = &Devices[address];
+	if (device->backoff != 0 && millis() < device->backoffUntil)
+		return false;
+	if (!mutexTake(BusMutex, 2))
+		return false;
+
+	bool success = false;
+	for (int attempt = 0; attempt <= IME_MANAGER_RETRIES && !success; attempt++)
+	{
+		unsigned long start = micros();
+		success = read(address, value);
+		device->latency = micros() - start;
+		if (device->latency > device->maxLatency)
+			device->maxLatency = device->latency;
+		device->reads++;
+		if (!success)
+			device->errors++;
+	}
+	mutexGive(BusMutex);
+
+	if (success)
+	{
+		device->consecutiveErrors = 0;
+		device->backoff = 0;
+		device->degraded = false;
+	}
+	else
+	{
+		device->consecutiveErrors++;
+		if (device->consecutiveErrors >= IME_MANAGER_DEGRADED_ERRORS)
+			device->degraded = true;
+		device->backoff = device->backoff == 0 ? IME_MANAGER_BACKOFF_MIN : device->backoff * 2;
+		if (device->backoff > IME_MANAGER_BACKOFF_MAX)
+			device->backoff = IME_MANAGER_BACKOFF_MAX;
+		device->backoffUntil = millis() + device->backoff;
+	}
+	return success;
+}
+
+/**
+ * @brief Gets the current count of an IME. Replaces imeGet().
+ *
+ * @param address
+ *			The IME address
+ *
+ * @param value
+ *			Set to the count on success, or to the last good count on failure (never left undefined)
+ *
+ * @returns Returns true if the value was read from the IME during this call
+ */
+bool IMEManagerGet(unsigned char address, int *value)
+{
+	int raw;
+	if (imeManagerRead(address, &imeGet, &raw))
+		Devices[address].lastValue = raw + Devices[address].offset;
+
+	*value = address < NumDevices ? Devices[address].lastValue : 0;
+	return address < NumDevices && Devices[address].consecutiveErrors == 0;
+}
+
+/**
+ * @brief Gets the current velocity of an IME. Replaces imeGetVelocity().
+ *
+ * @param address
+ *			The IME address
+ *
+ * @param value
+ *			Set to the velocity on success, or to 0 on failure
+ *
+ * @returns Returns true if the value was read from the IME during this call
+ */
+bool IMEManagerGetVelocity(unsigned char address, int *value)
+{
+	int raw;
+	if (imeManagerRead(address, &imeGetVelocity, &raw))
+	{
+		Devices[address].lastVelocity = raw;
+		*value = raw;
+		return true;
+	}
+	*value = 0;
+	return false;
+}
+
+/**
+ * @brief Resets the count of an IME to zero. Replaces imeReset().
+ *
+ * @param address
+ *			The IME address
+ *
+ * @returns Returns true if the IME acknowledged the reset
+ */
+bool IMEManagerReset(unsigned char address)
+{
+	if (address >= NumDevices)
+		return false;
+
+	Devices[address].offset = 0;
+	Devices[address].lastValue = 0;
+	if (Resetting || !mutexTake(BusMutex, IME_MANAGER_MUTEX_TIMEOUT))
+		return false;
+	bool success = imeReset(address);
+	mutexGive(BusMutex);
+	return success;
+}
+
+/**
+ * @brief Returns true if the IME is degraded and its values should not be trusted
+ *
+ * @param address
+ *			The IME address
+ */
+bool IMEManagerIsDegraded(unsigned char address)
+{
+	return address >= NumDevices || Devices[address].degraded;
+}
+
+/**
+ * @brief Returns a copy of the health information of an IME
+ *
+ * @param address
+ *			The IME address
+ */
+IMEDevice IMEManagerGetStatus(unsigned char address)
+{
+	IMEDevice none = { 0 };
+	none.degraded = true;
+	return address < NumDevices ? Devices[address] : none;
+}
+
+/**
+ * @brief Returns the number of times the IME chain has been re-initialized
+ */
+unsigned int IMEManagerGetBusResets()
+{
+	return BusResets;
+}
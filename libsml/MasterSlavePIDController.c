@@ -19,6 +19,26 @@
 #include "sml/SmartMotorLibrary.h"
 #include "lcd/LCDFunctions.h"
 
+/**
+ * @brief Returns the feedforward output of one side for the planned speed of a profile
+ *
+ * @param controller
+ *        A pointer to a MasterSlavePIDController
+ *
+ * @param velocity
+ *        The planned speed in ticks per second
+ *
+ * @param measured
+ *        Returns the measured speed of the side, may be NULL
+ */
+static int masterSlavePIDFeedforward(MasterSlavePIDController *controller, int velocity, int (*measured)(void))
+{
+	double output = controller->Kv * velocity;
+	if (measured != NULL)
+		output += controller->KvError * (velocity - measured());
+	return (int)output;
+}
+
 /**
  * @brief The task keeping the MasterSlavePIDController on target
  *
@@ -34,10 +54,30 @@ static void MasterSlavePIDControllerTask(void *c)
 	int masterOutput, slaveOutput;
 	while(true)
 	{
-		delay(15);
+		delay(MASTER_SLAVE_PID_DELTAT);
+
+		// Step along a profile by moving the goals directly, as PIDControllerSetGoal() would reset the controllers
+		int velocity = 0;
+		mutexTake(controller->profileMutex, -1);
+		if (controller->profileLength != 0)
+		{
+			int goal = controller->profile[controller->profileIndex];
+			if (controller->profileVelocities != NULL)
+				velocity = controller->profileVelocities[controller->profileIndex];
+			controller->master.Goal = goal;
+			controller->slave.Goal = goal;
+			if (++controller->profileIndex >= controller->profileLength)
+				controller->profileLength = 0;
+		}
+		mutexGive(controller->profileMutex);
 
 		masterOutput = controller->enabledPrimaryPID ? PIDControllerCompute(master) : controller->manualPrimaryOutput;
 		slaveOutput = controller->enabledPrimaryPID ? PIDControllerCompute(slave) : controller->manualPrimaryOutput;
+		if (controller->enabledPrimaryPID && velocity != 0)
+		{
+			masterOutput += masterSlavePIDFeedforward(controller, velocity, controller->masterVelocity);
+			slaveOutput += masterSlavePIDFeedforward(controller, velocity, controller->slaveVelocity);
+		}
 		
 		slaveOutput += PIDControllerCompute(equalizer);
 		masterOutput -= PIDControllerCompute(equalizer);
@@ -121,6 +161,15 @@ MasterSlavePIDController CreateMasterSlavePIDController(PIDController master, PI
 	controller.maxSpeed = max;
 	controller.minSpeed = min;
 	controller.enabledPrimaryPID = enabledPrimaryPID;
+	controller.profile = NULL;
+	controller.profileVelocities = NULL;
+	controller.profileLength = 0;
+	controller.profileIndex = 0;
+	controller.profileMutex = mutexCreate();
+	controller.Kv = 0;
+	controller.KvError = 0;
+	controller.masterVelocity = NULL;
+	controller.slaveVelocity = NULL;
 	return controller;
 }
 
@@ -143,6 +192,20 @@ TaskHandle InitializeMasterSlaveController(MasterSlavePIDController *controller,
 	return taskCreate(MasterSlavePIDControllerTask, TASK_DEFAULT_STACK_SIZE, controller, TASK_PRIORITY_DEFAULT);
 }
 
+/**
+ * @brief Stops any profile and sets the Primary PID Goal
+ *
+ * @pre The profile mutex is held
+ */
+static void masterSlavePIDSetGoal(MasterSlavePIDController *controller, int primaryPIDGoal)
+{
+	controller->profileLength = 0;
+	controller->enabledPrimaryPID = true;
+
+	PIDControllerSetGoal(&(controller->master), primaryPIDGoal);
+	PIDControllerSetGoal(&(controller->slave), primaryPIDGoal);
+}
+
 /**
  * @brief Changes the Primary PID Goal to the desired goal value.
  *
@@ -154,15 +217,15 @@ TaskHandle InitializeMasterSlaveController(MasterSlavePIDController *controller,
  */
 void MasterSlavePIDSetGoal(MasterSlavePIDController *controller, int primaryPIDGoal)
 {
-	controller->enabledPrimaryPID = true;
-
-	PIDControllerSetGoal(&(controller->master), primaryPIDGoal);
-	PIDControllerSetGoal(&(controller->slave), primaryPIDGoal);
+	mutexTake(controller->profileMutex, -1);
+	masterSlavePIDSetGoal(controller, primaryPIDGoal);
+	mutexGive(controller->profileMutex);
 }
 
 /**
  * @brief Increments the MSPID primary controller by an integer value
- *        If the controller was previously in direct-to-output mode, the current height will be taken and then deltaGoal applied
+ *        If the controller was previously in direct-to-output mode, the current height will be taken and then deltaGoal applied.
+ *        Stops any profile.
  *
  * @param controller
  *        Point to a MasterSlavePIDController struct containing information for the controller
@@ -172,6 +235,8 @@ void MasterSlavePIDSetGoal(MasterSlavePIDController *controller, int primaryPIDG
  */
 void MasterSlavePIDIncreaseGoal(MasterSlavePIDController *controller, int deltaGoal)
 {
+	mutexTake(controller->profileMutex, -1);
+	controller->profileLength = 0;
 	if (!controller->enabledPrimaryPID)
 	{
 		controller->enabledPrimaryPID = true;
@@ -181,6 +246,7 @@ void MasterSlavePIDIncreaseGoal(MasterSlavePIDController *controller, int deltaG
 
 	controller->master.Goal += deltaGoal;
 	controller->slave.Goal += deltaGoal;
+	mutexGive(controller->profileMutex);
 
 	//static int c = 0;
 	//lcdPrint(uart1, 1, "C: %d", c++);
@@ -198,15 +264,122 @@ void MasterSlavePIDIncreaseGoal(MasterSlavePIDController *controller, int deltaG
  */
 void MasterSlavePIDSetOutput(MasterSlavePIDController *controller, int output)
 {
+	mutexTake(controller->profileMutex, -1);
+	controller->profileLength = 0;
 	controller->enabledPrimaryPID = false;
 	controller->manualPrimaryOutput = output;
+	mutexGive(controller->profileMutex);
+}
+
+/**
+ * @brief Starts a profile, see MasterSlavePIDFollowProfile()
+ *
+ * @pre The profile mutex is held
+ */
+static void masterSlavePIDFollowProfile(MasterSlavePIDController *controller, const short *profile,
+	const short *velocities, unsigned short length)
+{
+	masterSlavePIDSetGoal(controller, profile[0]);
+	controller->profile = profile;
+	controller->profileVelocities = velocities;
+	controller->profileIndex = 1;
+	controller->profileLength = length > 1 ? length : 0;
+}
+
+/**
+ * @brief Moves the Primary PID Goal along a profile, one point every MASTER_SLAVE_PID_DELTAT milliseconds. The goal
+ *        stays at the last point. MasterSlavePIDSetGoal(), MasterSlavePIDIncreaseGoal() or MasterSlavePIDSetOutput()
+ *        stops the profile.
+ *
+ * @param controller
+ *        Point to a MasterSlavePIDController struct containing information for the controller
+ *
+ * @param profile
+ *        The goals, which must stay valid while the profile runs
+ *
+ * @param velocities
+ *        The planned speed at each goal in ticks per second, which must stay valid while the profile runs. NULL for no
+ *        feedforward (see MasterSlavePIDSetFeedforward()).
+ *
+ * @param length
+ *        Number of goals in profile
+ */
+void MasterSlavePIDFollowProfile(MasterSlavePIDController *controller, const short *profile, const short *velocities,
+	unsigned short length)
+{
+	if (length == 0)
+		return;
+	mutexTake(controller->profileMutex, -1);
+	masterSlavePIDFollowProfile(controller, profile, velocities, length);
+	mutexGive(controller->profileMutex);
+}
+
+/**
+ * @brief Starts a profile like MasterSlavePIDFollowProfile() unless the controller is already following it or holding
+ *        its last point. Meant to be called every pass of a loop.
+ *
+ * @param controller
+ *        Point to a MasterSlavePIDController struct containing information for the controller
+ *
+ * @param profile
+ *        The goals, which must stay valid while the profile runs
+ *
+ * @param velocities
+ *        The planned speed at each goal in ticks per second, or NULL
+ *
+ * @param length
+ *        Number of goals in profile
+ *
+ * @return Returns true once the profile has ended and the controller is on target
+ */
+bool MasterSlavePIDFollowProfileContinuous(MasterSlavePIDController *controller, const short *profile,
+	const short *velocities, unsigned short length)
+{
+	if (length == 0)
+		return MasterSlavePIDOnTarget(controller);
+	mutexTake(controller->profileMutex, -1);
+	bool following = controller->profileLength != 0 && controller->profile == profile;
+	if (!following && (!controller->enabledPrimaryPID || controller->master.Goal != profile[length - 1]))
+		masterSlavePIDFollowProfile(controller, profile, velocities, length);
+	mutexGive(controller->profileMutex);
+	return MasterSlavePIDOnTarget(controller);
+}
+
+/**
+ * @brief Sets the velocity feedforward added to both outputs while a profile runs. The planned speed is the one given
+ *        with the profile to MasterSlavePIDFollowProfile().
+ *
+ * @param controller
+ *        Point to a MasterSlavePIDController struct containing information for the controller
+ *
+ * @param Kv
+ *        PWM per tick per second of planned speed
+ *
+ * @param KvError
+ *        PWM per tick per second the measured speed falls short of the planned speed
+ *
+ * @param masterVelocity
+ *        Returns the speed of the master in ticks per second, NULL to leave out its KvError term
+ *
+ * @param slaveVelocity
+ *        Returns the speed of the slave in ticks per second, NULL to leave out its KvError term
+ */
+void MasterSlavePIDSetFeedforward(MasterSlavePIDController *controller, double Kv, double KvError,
+	int (*masterVelocity)(void), int (*slaveVelocity)(void))
+{
+	controller->Kv = Kv;
+	controller->KvError = KvError;
+	controller->masterVelocity = masterVelocity;
+	controller->slaveVelocity = slaveVelocity;
 }
 
 /**
- * @brief Returns true if the MasterSlavePIDController is on target
+ * @brief Returns true if the MasterSlavePIDController is on target. Never true while a profile is running.
  */
 bool MasterSlavePIDOnTarget(MasterSlavePIDController *controller)
 {
+	if (controller->profileLength != 0)
+		return false;
 	return
 		((abs(controller->master.Goal - controller->master.Call()) < controller->master.AcceptableTolerance) &&
 		(abs(controller->slave.Goal - controller->slave.Call()) < controller->slave.AcceptableTolerance));
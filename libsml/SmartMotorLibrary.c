@@ -226,4 +226,21 @@ void MotorChangeRecalculateCommanded(int channel, int(*func)(int))
 	channel--;
 
 	Motors[channel].RecalculateCommanded = func;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Changes the skew (slew rate) of a motor, keeping the rest of its configuration
+ *
+ * @param channel
+ *        The port of the motor [1,10]
+ *
+ * @param skewPerMsec
+ *        The new maximum change of the PWM value per millisecond
+ */
+void MotorChangeSkew(int channel, double skewPerMsec)
+{
+	if (channel < 1 || channel > 10)
+		return;
+
+	Motors[channel - 1].skewPerMsec = skewPerMsec;
+}
@@ -0,0 +1,254 @@
+/**
+ * @file tools/autonasm.c
+ * @author Elliot Berman
+ * @brief Host assembler for the autonomous scripts run by vulcan/AutonScript.c.
+ *
+ * @details Reads a script with one step per line and writes the file saved by AutonScriptReceive(): the header, the
+ *          code (all steps wrapped in one sequence, then AutonOpEnd), and the XOR of the code. The output can be sent
+ *          straight to the robot while it is listening (LCD menu: Autonomous > Receive script). Build and run on the
+ *          host with
+ * @code
+ *		gcc -std=gnu99 -O2 -Iinclude -o autonasm tools/autonasm.c -lm
+ *		stty -F /dev/ttyACM0 115200 raw && ./autonasm blue.auton /dev/ttyACM0
+ * @endcode
+ *          Steps (numbers are integers unless noted, # starts a comment):
+ * @code
+ *		drive left right				Chassis PID to IME goals
+ *		set left right ms				Chassis open loop for ms, then stop
+ *		mecanum heading speed rot ms	heading in radians (decimal)
+ *		lift height
+ *		claw 0|1
+ *		needle 0|1
+ *		wait ms
+ *		until time|liftabove|liftbelow|line value [timeout]
+ *		reset							Reset the chassis IMEs
+ *		sequence|parallel|race|deadline {
+ *			steps...
+ *		}
+ * @endcode
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+// Only the definitions of the format are needed, not the PROS API included by main.h
+#define MAIN_H_
+#include "vulcan/AutonScript.h"
+
+#define AUTONASM_MAX_LINE		256
+#define AUTONASM_MAX_GROUP		255 // The count of a group is one byte
+
+typedef struct
+{
+	const char *name;
+	AutonOp op;
+	int numArgs;
+} Instruction;
+
+static const Instruction Instructions[] = {
+	{ "drive", AutonOpDrive, 2 },
+	{ "set", AutonOpSet, 3 },
+	{ "mecanum", AutonOpMecanum, 4 },
+	{ "lift", AutonOpLift, 1 },
+	{ "claw", AutonOpClaw, 1 },
+	{ "needle", AutonOpNeedle, 1 },
+	{ "wait", AutonOpWait, 1 },
+	{ "until", AutonOpUntil, 3 },
+	{ "reset", AutonOpReset, 0 },
+	{ "sequence", AutonOpSequence, 0 },
+	{ "parallel", AutonOpParallel, 0 },
+	{ "race", AutonOpRace, 0 },
+	{ "deadline", AutonOpDeadline, 0 },
+};
+
+static const char *Conditions[] = { "time", "liftabove", "liftbelow", "line" };
+
+static unsigned char Code[AUTON_SCRIPT_MAX_SIZE];
+static unsigned int Length;
+/**
+ * @brief Position of the count byte and number of steps of every open group, [0] being the whole script
+ */
+static unsigned int GroupCount[AUTON_SCRIPT_MAX_DEPTH], GroupSteps[AUTON_SCRIPT_MAX_DEPTH];
+static int Depth;
+static int LineNumber;
+
+static void fail(const char *message)
+{
+	fprintf(stderr, "line %d: %s\n", LineNumber, message);
+	exit(1);
+}
+
+static void emit(int byte)
+{
+	if (Length >= AUTON_SCRIPT_MAX_SIZE)
+		fail("script too long");
+	Code[Length++] = (unsigned char)byte;
+}
+
+static void emitArg(long value)
+{
+	if (value < -32768 || value > 32767)
+		fail("argument out of range");
+	emit(value & 0xFF);
+	emit((value >> 8) & 0xFF);
+}
+
+static long parseInt(const char *token)
+{
+	char *end;
+	long value = strtol(token, &end, 0);
+	if (*token == '\0' || *end != '\0')
+		fail("expected an integer");
+	return value;
+}
+
+static void openGroup(AutonOp op)
+{
+	if (Depth + 1 >= AUTON_SCRIPT_MAX_DEPTH)
+		fail("groups nested too deeply");
+	emit(op);
+	GroupCount[++Depth] = Length;
+	GroupSteps[Depth] = 0;
+	emit(0);
+}
+
+static void closeGroup()
+{
+	if (GroupSteps[Depth] > AUTONASM_MAX_GROUP)
+		fail("group has too many steps");
+	Code[GroupCount[Depth]] = (unsigned char)GroupSteps[Depth];
+	Depth--;
+}
+
+static void assembleLine(char *line)
+{
+	char *comment = strchr(line, '#');
+	if (comment != NULL)
+		*comment = '\0';
+	char *tokens[8];
+	int numTokens = 0;
+	for (char *token = strtok(line, " \t\r\n"); token != NULL; token = strtok(NULL, " \t\r\n"))
+	{
+		if (numTokens >= 8)
+			fail("too many arguments");
+		tokens[numTokens++] = token;
+	}
+	if (numTokens == 0)
+		return;
+
+	if (strcmp(tokens[0], "}") == 0)
+	{
+		if (Depth == 0 || numTokens != 1)
+			fail("unexpected }");
+		closeGroup();
+		return;
+	}
+
+	const Instruction *instruction = NULL;
+	for (unsigned int i = 0; i < sizeof(Instructions) / sizeof(Instruction); i++)
+		if (strcmp(tokens[0], Instructions[i].name) == 0)
+			instruction = &Instructions[i];
+	if (instruction == NULL)
+		fail("unknown step");
+	GroupSteps[Depth]++;
+
+	if (instruction->op >= AutonOpSequence)
+	{
+		if (numTokens != 2 || strcmp(tokens[1], "{") != 0)
+			fail("expected {");
+		openGroup(instruction->op);
+		return;
+	}
+
+	if (instruction->op == AutonOpUntil)
+	{
+		if (numTokens != 3 && numTokens != 4)
+			fail("expected a condition, a value, and an optional timeout");
+		int condition = -1;
+		for (unsigned int i = 0; i < sizeof(Conditions) / sizeof(char *); i++)
+			if (strcmp(tokens[1], Conditions[i]) == 0)
+				condition = i;
+		if (condition == -1)
+			fail("unknown condition");
+		emit(AutonOpUntil);
+		emitArg(condition);
+		emitArg(parseInt(tokens[2]));
+		emitArg(numTokens == 4 ? parseInt(tokens[3]) : 0);
+		return;
+	}
+
+	if (numTokens != instruction->numArgs + 1)
+		fail("wrong number of arguments");
+	emit(instruction->op);
+	for (int i = 1; i < numTokens; i++)
+	{
+		if (instruction->op == AutonOpMecanum && i == 1)
+		{
+			char *end;
+			double heading = strtod(tokens[1], &end);
+			if (*end != '\0')
+				fail("expected a heading in radians");
+			emitArg(lround(heading * 1000));
+		}
+		else
+			emitArg(parseInt(tokens[i]));
+	}
+}
+
+int main(int argc, char **argv)
+{
+	if (argc != 3)
+	{
+		fprintf(stderr, "usage: %s script output\n", argv[0]);
+		return 1;
+	}
+	FILE *in = fopen(argv[1], "r");
+	if (in == NULL)
+	{
+		perror(argv[1]);
+		return 1;
+	}
+
+	// The robot runs a single step, so wrap the whole script in a sequence
+	emit(AutonOpSequence);
+	GroupCount[0] = Length;
+	emit(0);
+
+	char line[AUTONASM_MAX_LINE];
+	while (fgets(line, sizeof(line), in) != NULL)
+	{
+		LineNumber++;
+		assembleLine(line);
+	}
+	fclose(in);
+	if (Depth != 0)
+		fail("missing }");
+	closeGroup();
+	emit(AutonOpEnd);
+
+	unsigned char header[AUTON_SCRIPT_HEADER_SIZE] = { 'A', 'S', AUTON_SCRIPT_VERSION, Length & 0xFF, Length >> 8 };
+	unsigned char check = 0;
+	for (unsigned int i = 0; i < Length; i++)
+		check ^= Code[i];
+
+	FILE *out = fopen(argv[2], "wb");
+	if (out == NULL)
+	{
+		perror(argv[2]);
+		return 1;
+	}
+	fwrite(header, 1, AUTON_SCRIPT_HEADER_SIZE, out);
+	fwrite(Code, 1, Length, out);
+	fwrite(&check, 1, 1, out);
+	fclose(out);
+	printf("%u bytes of code\n", Length);
+	return 0;
+}
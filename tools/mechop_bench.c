@@ -0,0 +1,101 @@
+/**
+ * @file tools/mechop_bench.c
+ * @author Elliot Berman
+ * @brief Host benchmark comparing the integer joystick classifier of vulcan/mechop.c with the floating point one.
+ *
+ * @details Runs every joystick position in [-127,127] x [-127,127] through thetaSector(getJoyTheta()) and joySector(),
+ *          and every pair of positions on a coarser grid through aHypo(cHypo(), cHypo()) and joyHypoAverage(). Prints
+ *          the number of differing results and the time taken by each. Build and run on the host with
+ * @code
+ *		gcc -std=gnu99 -O2 -Iinclude -o mechop_bench tools/mechop_bench.c vulcan/mechop.c -lm && ./mechop_bench
+ * @endcode
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include "vulcan/mechop.h"
+
+#define BENCH_PASSES		20
+#define BENCH_HYPO_STEP		3
+
+// mechop.c drives the chassis from JoystickControl(), which is not benchmarked
+void ChassisSet(int left, int right, bool immediate) { }
+void ChassisSetMecanum(double heading, int speed, int rotation, bool immediate) { }
+void ChassisSetHolonomic(int forward, int strafe, int rotation, bool immediate) { }
+
+static volatile int Sink;
+
+static double seconds(clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+int main()
+{
+	long mismatches = 0, calls = 0;
+	clock_t start;
+
+	for (int x = -127; x <= 127; x++)
+		for (int y = -127; y <= 127; y++)
+			if (thetaSector(getJoyTheta(x, y)) != joySector(x, y))
+			{
+				if (mismatches++ < 10)
+					printf("sector mismatch at (%d, %d): %d vs %d\n", x, y, thetaSector(getJoyTheta(x, y)), joySector(x, y));
+			}
+	printf("sectors:  %ld mismatches out of %d\n", mismatches, 255 * 255);
+
+	start = clock();
+	for (int pass = 0; pass < BENCH_PASSES; pass++)
+		for (int x = -127; x <= 127; x++)
+			for (int y = -127; y <= 127; y++, calls++)
+				Sink = thetaSector(getJoyTheta(x, y));
+	double floating = seconds(start);
+	start = clock();
+	for (int pass = 0; pass < BENCH_PASSES; pass++)
+		for (int x = -127; x <= 127; x++)
+			for (int y = -127; y <= 127; y++)
+				Sink = joySector(x, y);
+	double integer = seconds(start);
+	printf("          float %.1f ns/call, integer %.1f ns/call\n", floating * 1e9 / calls, integer * 1e9 / calls);
+
+	mismatches = 0;
+	calls = 0;
+	long off = 0;
+	start = clock();
+	for (int x1 = -127; x1 <= 127; x1 += BENCH_HYPO_STEP)
+		for (int y1 = -127; y1 <= 127; y1 += BENCH_HYPO_STEP)
+			for (int x2 = -127; x2 <= 127; x2 += BENCH_HYPO_STEP)
+				for (int y2 = -127; y2 <= 127; y2 += BENCH_HYPO_STEP, calls++)
+				{
+					int difference = aHypo(cHypo(x1, y1), cHypo(x2, y2)) - joyHypoAverage(x1, y1, x2, y2);
+					if (difference != 0)
+						mismatches++;
+					if (abs(difference) > 1)
+						off++;
+				}
+	printf("hypot:    %ld mismatches (%ld by more than 1) out of %ld\n", mismatches, off, calls);
+
+	start = clock();
+	for (int x1 = -127; x1 <= 127; x1 += BENCH_HYPO_STEP)
+		for (int y1 = -127; y1 <= 127; y1 += BENCH_HYPO_STEP)
+			for (int x2 = -127; x2 <= 127; x2 += BENCH_HYPO_STEP)
+				for (int y2 = -127; y2 <= 127; y2 += BENCH_HYPO_STEP)
+					Sink = aHypo(cHypo(x1, y1), cHypo(x2, y2));
+	floating = seconds(start);
+	start = clock();
+	for (int x1 = -127; x1 <= 127; x1 += BENCH_HYPO_STEP)
+		for (int y1 = -127; y1 <= 127; y1 += BENCH_HYPO_STEP)
+			for (int x2 = -127; x2 <= 127; x2 += BENCH_HYPO_STEP)
+				for (int y2 = -127; y2 <= 127; y2 += BENCH_HYPO_STEP)
+					Sink = joyHypoAverage(x1, y1, x2, y2);
+	integer = seconds(start);
+	printf("          float %.1f ns/call, integer %.1f ns/call\n", floating * 1e9 / calls, integer * 1e9 / calls);
+	return 0;
+}
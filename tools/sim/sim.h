@@ -0,0 +1,80 @@
+/**
+ * @file tools/sim/sim.h
+ * @author Elliot Berman
+ * @brief Shared state of the host simulator. See tools/sim/simmain.c.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include "main.h"
+
+#define SIM_NUM_PINS			13 // Digital pins 1-12, 0 unused
+#define SIM_NUM_ANALOG			9 // Analog pins 1-8, 0 unused
+#define SIM_NUM_IMES			4
+#define SIM_MAX_LINES			8
+
+/**
+ * @brief Everything the robot code can read from or write to, plus the plant
+ */
+typedef struct
+{
+	/**
+	 * @brief Virtual time in microseconds
+	 */
+	unsigned long long now;
+
+	// Outputs of the robot code
+	int motors[11];
+	bool outputs[SIM_NUM_PINS];
+	unsigned char modes[SIM_NUM_PINS];
+	InterruptHandler interrupts[SIM_NUM_PINS];
+	char lcd[2][17];
+
+	// Inputs of the robot code, set by the plant
+	bool pins[SIM_NUM_PINS];
+	int analog[SIM_NUM_ANALOG];
+	double imes[SIM_NUM_IMES];
+	double imeVelocities[SIM_NUM_IMES];
+	double imeOffsets[SIM_NUM_IMES];
+
+	// Plant
+	/**
+	 * @brief Pose of the chassis on the field in inches and radians (counterclockwise), x forward at the start
+	 */
+	double x, y, heading;
+	/**
+	 * @brief Wheel speeds in IME ticks per second: front right, rear right, front left, rear left
+	 */
+	double wheels[4];
+	/**
+	 * @brief Height of each side of the lift in quadrature encoder ticks, and its speed in ticks per second
+	 */
+	double lift[2], liftSpeed[2];
+	int liftCount[2];
+	/**
+	 * @brief Field lines (x in inches) seen by the IR sensors
+	 */
+	double lines[SIM_MAX_LINES];
+	int numLines;
+} SimState;
+
+extern SimState Sim;
+extern bool SimVerbose;
+
+///@cond
+void SimPrint(int, const char *, ...);
+void SimPlantInitialize();
+void SimPlantStep(double);
+void SimTraceOpen(const char *);
+void SimTraceSample();
+void SimTraceClose();
+void SimFilesSetDirectory(const char *);
+void SimRun(void (*)(void), unsigned long long);
+///@endcond
+#endif
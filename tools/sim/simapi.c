@@ -0,0 +1,557 @@
+/**
+ * @file tools/sim/simapi.c
+ * @author Elliot Berman
+ * @brief The PROS API calls used by Vulcan, implemented on virtual time for the host simulator.
+ *
+ * @details Tasks are cooperative (ucontext): a task runs until it calls delay(), taskDelayUntil(), or blocks on a
+ *          mutex. The scheduler then switches to the task with the earliest wake time (highest priority first among
+ *          equals), advancing virtual time and stepping the plant every millisecond on the way, so a routine runs as
+ *          fast as the host can compute it. Interrupt handlers set with ioSetInterrupt() are called from the plant
+ *          step. <br>
+ *          Files opened with fopen() live in a directory of the host (see SimFilesSetDirectory()). stdout goes to the
+ *          host's stdout, stdin never has data. <br>
+ *          This file replaces the stream functions of the C library for the whole program, so the simulator itself
+ *          prints with SimPrint() and POSIX calls.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <sys/stat.h>
+
+#include "sim.h"
+
+// stdio.h cannot be included with the PROS FILE, so declare the one formatting function needed
+int vsnprintf(char *, size_t, const char *, va_list);
+
+#define SIM_STACK_SIZE			(256 * 1024) // Host stack frames are much bigger than the Cortex's
+#define SIM_NUM_FILES			8
+#define SIM_FILE_HANDLE			16 // Open files are FILE handles from here on, past stdout and the UARTs
+#define SIM_PRINT_SIZE			512
+#define SIM_PATH_SIZE			256
+
+SimState Sim;
+bool SimVerbose;
+
+// ---------------- TASKS ---------------- //
+typedef struct
+{
+	ucontext_t context;
+	void *stack;
+	TaskCode code;
+	void *parameters;
+	unsigned int priority;
+	/**
+	 * @brief Virtual time (microseconds) at which the task can run again
+	 */
+	unsigned long long wake;
+	bool alive;
+} SimTask;
+
+typedef struct
+{
+	SimTask *owner;
+} SimMutex;
+
+static SimTask Tasks[TASK_MAX];
+static SimTask *Current;
+static ucontext_t MainContext;
+static unsigned long long PlantTime, Limit;
+static bool Finished;
+static void (*Entry)(void);
+
+/**
+ * @brief Switches to the next task to run. Called by the current task once it has set its wake time, or has died.
+ *        Returns when the current task is scheduled again.
+ */
+static void simSchedule()
+{
+	while (true)
+	{
+		SimTask *best = NULL;
+		int start = Current == NULL ? 0 : (int)(Current - Tasks) + 1;
+		// Round robin from the task after the current one among tasks with the same wake time and priority
+		for (int n = 0; n < TASK_MAX; n++)
+		{
+			SimTask *task = &Tasks[(start + n) % TASK_MAX];
+			if (task->alive && (best == NULL || task->wake < best->wake ||
+				(task->wake == best->wake && task->priority > best->priority)))
+				best = task;
+		}
+		if (best == NULL || Finished)
+			break;
+
+		while (PlantTime + 1000 <= best->wake)
+		{
+			PlantTime += 1000;
+			Sim.now = PlantTime;
+			SimPlantStep(0.001);
+			if (Sim.now >= Limit)
+			{
+				Finished = true;
+				break;
+			}
+		}
+		if (Finished)
+			break;
+		if (best->wake > Sim.now)
+			Sim.now = best->wake;
+
+		if (best != Current)
+		{
+			SimTask *previous = Current;
+			Current = best;
+			swapcontext(&previous->context, &best->context);
+		}
+		return;
+	}
+
+	SimTask *previous = Current;
+	Current = NULL;
+	swapcontext(&previous->context, &MainContext);
+}
+
+static void simTaskEntry(int index)
+{
+	Tasks[index].code(Tasks[index].parameters);
+	Tasks[index].alive = false;
+	simSchedule();
+}
+
+TaskHandle taskCreate(TaskCode taskCode, const unsigned int stackDepth, void *parameters, const unsigned int priority)
+{
+	for (int i = 0; i < TASK_MAX; i++)
+	{
+		SimTask *task = &Tasks[i];
+		if (task->alive || task == Current)
+			continue;
+		if (task->stack == NULL)
+			task->stack = malloc(SIM_STACK_SIZE);
+		getcontext(&task->context);
+		task->context.uc_stack.ss_sp = task->stack;
+		task->context.uc_stack.ss_size = SIM_STACK_SIZE;
+		task->context.uc_link = NULL;
+		makecontext(&task->context, (void (*)())simTaskEntry, 1, i);
+		task->code = taskCode;
+		task->parameters = parameters;
+		task->priority = priority;
+		task->wake = Sim.now;
+		task->alive = true;
+		return task;
+	}
+	return NULL;
+}
+
+void taskDelete(TaskHandle taskToDelete)
+{
+	SimTask *task = taskToDelete == NULL ? Current : taskToDelete;
+	task->alive = false;
+	if (task == Current)
+		simSchedule();
+}
+
+void delay(const unsigned long time)
+{
+	Current->wake = Sim.now + time * 1000ULL;
+	simSchedule();
+}
+
+void delayMicroseconds(const unsigned long us)
+{
+	Current->wake = Sim.now + us;
+	simSchedule();
+}
+
+void taskDelayUntil(unsigned long *previousWakeTime, const unsigned long cycleTime)
+{
+	*previousWakeTime += cycleTime;
+	unsigned long long wake = *previousWakeTime * 1000ULL;
+	Current->wake = wake > Sim.now ? wake : Sim.now;
+	simSchedule();
+}
+
+unsigned long millis()
+{
+	return (unsigned long)(Sim.now / 1000);
+}
+
+unsigned long micros()
+{
+	return (unsigned long)Sim.now;
+}
+
+Mutex mutexCreate()
+{
+	return calloc(1, sizeof(SimMutex));
+}
+
+bool mutexTake(Mutex mutex, const unsigned long blockTime)
+{
+	SimMutex *m = mutex;
+	unsigned long long until = Sim.now + blockTime * 1000ULL;
+	while (m->owner != NULL)
+	{
+		if (blockTime != (unsigned long)-1 && Sim.now >= until)
+			return false;
+		delay(1);
+	}
+	m->owner = Current;
+	return true;
+}
+
+bool mutexGive(Mutex mutex)
+{
+	SimMutex *m = mutex;
+	if (m->owner != Current)
+		return false;
+	m->owner = NULL;
+	return true;
+}
+
+static void simEntryTask(void *none)
+{
+	Entry();
+	Finished = true;
+}
+
+/**
+ * @brief Runs a function in a task (with everything it starts) until it returns or virtual time reaches limit
+ *
+ * @param entry
+ *			The function, e.g. one that calls initialize() and autonomous()
+ *
+ * @param limit
+ *			Virtual time in microseconds at which to stop
+ */
+void SimRun(void (*entry)(void), unsigned long long limit)
+{
+	Entry = entry;
+	Limit = limit;
+	Finished = false;
+	PlantTime = Sim.now - Sim.now % 1000;
+	SimTask *task = taskCreate(&simEntryTask, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_DEFAULT);
+	Current = task;
+	swapcontext(&MainContext, &task->context);
+}
+
+// ---------------- IO ---------------- //
+int analogRead(unsigned char channel)
+{
+	return channel < SIM_NUM_ANALOG ? Sim.analog[channel] : 0;
+}
+
+bool digitalRead(unsigned char pin)
+{
+	if (pin >= SIM_NUM_PINS)
+		return false;
+	return Sim.modes[pin] == OUTPUT ? Sim.outputs[pin] : Sim.pins[pin];
+}
+
+void digitalWrite(unsigned char pin, bool value)
+{
+	if (pin < SIM_NUM_PINS)
+		Sim.outputs[pin] = value;
+}
+
+void pinMode(unsigned char pin, unsigned char mode)
+{
+	if (pin < SIM_NUM_PINS)
+		Sim.modes[pin] = mode;
+}
+
+void ioSetInterrupt(unsigned char pin, unsigned char edges, InterruptHandler handler)
+{
+	if (pin < SIM_NUM_PINS)
+		Sim.interrupts[pin] = handler;
+}
+
+void ioClearInterrupt(unsigned char pin)
+{
+	if (pin < SIM_NUM_PINS)
+		Sim.interrupts[pin] = NULL;
+}
+
+int motorGet(unsigned char channel)
+{
+	return (channel >= 1 && channel <= 10) ? Sim.motors[channel] : 0;
+}
+
+void motorSet(unsigned char channel, int speed)
+{
+	if (channel >= 1 && channel <= 10)
+		Sim.motors[channel] = speed > 127 ? 127 : (speed < -127 ? -127 : speed);
+}
+
+unsigned int imeInitializeAll()
+{
+	return SIM_NUM_IMES;
+}
+
+bool imeGet(unsigned char address, int *value)
+{
+	if (address >= SIM_NUM_IMES)
+		return false;
+	*value = (int)(Sim.imes[address] - Sim.imeOffsets[address]);
+	return true;
+}
+
+bool imeGetVelocity(unsigned char address, int *value)
+{
+	if (address >= SIM_NUM_IMES)
+		return false;
+	*value = (int)Sim.imeVelocities[address];
+	return true;
+}
+
+bool imeReset(unsigned char address)
+{
+	if (address >= SIM_NUM_IMES)
+		return false;
+	Sim.imeOffsets[address] = Sim.imes[address];
+	return true;
+}
+
+void imeShutdown()
+{
+}
+
+// ---------------- COMPETITION, JOYSTICK, AND LCD ---------------- //
+bool isEnabled()
+{
+	return true;
+}
+
+bool isOnline()
+{
+	return false;
+}
+
+bool isJoystickConnected(unsigned char joystick)
+{
+	return false;
+}
+
+int joystickGetAnalog(unsigned char joystick, unsigned char axis)
+{
+	return 0;
+}
+
+bool joystickGetDigital(unsigned char joystick, unsigned char buttonGroup, unsigned char button)
+{
+	return false;
+}
+
+unsigned int powerLevelMain()
+{
+	return 7800;
+}
+
+void setTeamName(const char *name)
+{
+}
+
+void lcdInit(FILE *lcdPort)
+{
+}
+
+void lcdShutdown(FILE *lcdPort)
+{
+}
+
+void lcdSetBacklight(FILE *lcdPort, bool backlight)
+{
+}
+
+unsigned int lcdReadButtons(FILE *lcdPort)
+{
+	return 0;
+}
+
+void lcdSetText(FILE *lcdPort, unsigned char line, const char *buffer)
+{
+	if (line < 1 || line > 2)
+		return;
+	char *text = Sim.lcd[line - 1];
+	if (strncmp(text, buffer, 16) == 0)
+		return;
+	strncpy(text, buffer, 16);
+	text[16] = '\0';
+	if (SimVerbose)
+		SimPrint(2, "[%7.3f] LCD %d: %s\n", Sim.now / 1000000.0, line, text);
+}
+
+// ---------------- FILES AND STREAMS ---------------- //
+typedef struct
+{
+	int fd;
+	bool used;
+	bool reading;
+} SimFile;
+
+static SimFile Files[SIM_NUM_FILES];
+static char Directory[SIM_PATH_SIZE] = "simflash";
+
+/**
+ * @brief printf() for the simulator itself, to a host file descriptor
+ */
+void SimPrint(int fd, const char *format, ...)
+{
+	char buffer[SIM_PRINT_SIZE];
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+	if (length > (int)sizeof(buffer) - 1)
+		length = sizeof(buffer) - 1;
+	if (length > 0 && write(fd, buffer, length) < 0)
+		return;
+}
+
+/**
+ * @brief Sets the host directory which holds the files of the simulated flash, creating it if needed
+ */
+void SimFilesSetDirectory(const char *directory)
+{
+	strncpy(Directory, directory, sizeof(Directory) - 1);
+	mkdir(Directory, 0755);
+}
+
+static void simFilePath(const char *file, char *path)
+{
+	snprintf(path, SIM_PATH_SIZE, "%s/%s", Directory, file);
+}
+
+/**
+ * @brief Returns the open file behind stream, or NULL for a serial port. Like PROS, a FILE * is a small integer which
+ *        is never dereferenced.
+ */
+static SimFile *simFile(FILE *stream)
+{
+	uintptr_t handle = (uintptr_t)stream;
+	if (handle < SIM_FILE_HANDLE || handle >= SIM_FILE_HANDLE + SIM_NUM_FILES)
+		return NULL;
+	SimFile *file = &Files[handle - SIM_FILE_HANDLE];
+	return file->used ? file : NULL;
+}
+
+FILE *fopen(const char *file, const char *mode)
+{
+	char path[SIM_PATH_SIZE];
+	simFilePath(file, path);
+	for (int i = 0; i < SIM_NUM_FILES; i++)
+	{
+		if (Files[i].used)
+			continue;
+		Files[i].reading = mode[0] == 'r';
+		Files[i].fd = Files[i].reading ? open(path, O_RDONLY) : open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (Files[i].fd < 0)
+			return NULL;
+		Files[i].used = true;
+		return (FILE *)(uintptr_t)(SIM_FILE_HANDLE + i);
+	}
+	return NULL;
+}
+
+void fclose(FILE *stream)
+{
+	SimFile *file = simFile(stream);
+	if (file == NULL)
+		return;
+	close(file->fd);
+	file->used = false;
+}
+
+int fdelete(const char *file)
+{
+	char path[SIM_PATH_SIZE];
+	simFilePath(file, path);
+	return unlink(path) == 0 ? 0 : 1;
+}
+
+int fcount(FILE *stream)
+{
+	SimFile *file = simFile(stream);
+	if (file == NULL || !file->reading)
+		return 0;
+	off_t position = lseek(file->fd, 0, SEEK_CUR), end = lseek(file->fd, 0, SEEK_END);
+	lseek(file->fd, position, SEEK_SET);
+	return (int)(end - position);
+}
+
+int fgetc(FILE *stream)
+{
+	SimFile *file = simFile(stream);
+	unsigned char c;
+	if (file == NULL || read(file->fd, &c, 1) != 1)
+		return -1;
+	return c;
+}
+
+size_t fread(void *ptr, size_t size, size_t count, FILE *stream)
+{
+	SimFile *file = simFile(stream);
+	if (file == NULL || size == 0)
+		return 0;
+	size_t total = 0, wanted = size * count;
+	while (total < wanted)
+	{
+		ssize_t got = read(file->fd, (char *)ptr + total, wanted - total);
+		if (got <= 0)
+			break;
+		total += got;
+	}
+	return total / size;
+}
+
+size_t fwrite(const void *ptr, size_t size, size_t count, FILE *stream)
+{
+	SimFile *file = simFile(stream);
+	int fd = file != NULL ? file->fd : (stream == stdout ? 1 : -1);
+	if (fd < 0 || size == 0)
+		return count; // Nothing listens on the UARTs
+	ssize_t written = write(fd, ptr, size * count);
+	return written < 0 ? 0 : (size_t)written / size;
+}
+
+int fputs(const char *string, FILE *stream)
+{
+	return fwrite(string, 1, strlen(string), stream) == strlen(string) ? 1 : -1;
+}
+
+int fputc(int value, FILE *stream)
+{
+	unsigned char c = value;
+	return fwrite(&c, 1, 1, stream) == 1 ? value : -1;
+}
+
+int fprintf(FILE *stream, const char *formatString, ...)
+{
+	char buffer[SIM_PRINT_SIZE];
+	va_list args;
+	va_start(args, formatString);
+	int length = vsnprintf(buffer, sizeof(buffer), formatString, args);
+	va_end(args);
+	fputs(buffer, stream);
+	return length;
+}
+
+int printf(const char *formatString, ...)
+{
+	char buffer[SIM_PRINT_SIZE];
+	va_list args;
+	va_start(args, formatString);
+	int length = vsnprintf(buffer, sizeof(buffer), formatString, args);
+	va_end(args);
+	fputs(buffer, stdout);
+	return length;
+}
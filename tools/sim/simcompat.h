@@ -0,0 +1,23 @@
+/**
+ * @file tools/sim/simcompat.h
+ * @author Elliot Berman
+ * @brief Forced into every file of the simulator build (gcc -include) so the robot code compiles unchanged on the host.
+ *
+ * @details The ARM newlib signbit() accepts integers, which the chassis code relies on. glibc's only accepts floating
+ *          point, so it is replaced after math.h has been included once.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#ifndef SIMCOMPAT_H_
+#define SIMCOMPAT_H_
+
+#include <math.h>
+
+#undef signbit
+#define signbit(x)		((x) < 0)
+
+#endif
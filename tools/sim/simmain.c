@@ -0,0 +1,143 @@
+/**
+ * @file tools/sim/simmain.c
+ * @author Elliot Berman
+ * @brief Host simulator which runs the Vulcan autonomous routines faster than real time against models of the robot.
+ *
+ * @details The robot code (libsml, liblcd, and vulcan) is compiled unchanged for the host and linked with a PROS API
+ *          implemented on virtual time (simapi.c) and models of the mecanum base and lift (simplant.c). initialize()
+ *          runs first, then autonomous() with the chosen routine, until it returns or the time limit passes. A
+ *          trajectory trace (CSV, every 10 milliseconds) and a summary are written. Build and run on the host with
+ * @code
+ *		gcc -std=gnu99 -O2 -fsigned-char -fcommon -fno-builtin -Iinclude -Itools/sim -include tools/sim/simcompat.h \
+ *			-DVERSION='"sim"' -o vulcansim $(find tools/sim libsml liblcd vulcan -name '*.c') -lm
+ *		./vulcansim -t trace.csv "Red Sky"
+ * @endcode
+ *          Options:
+ * @code
+ *		-t file		Write the trace to file (default trace.csv)
+ *		-f dir		Directory holding the files of the simulated flash, e.g. a ghost or a script (default simflash)
+ *		-l x		Add a white line across the field x inches ahead of the start, seen by the IR sensors (repeatable,
+ *					default one line at -18, behind the red skyrise tile)
+ *		-s seconds	Time limit of the routine (default 15)
+ *		-v			Print the LCD as it changes
+ * @endcode
+ *          Add -DAUTO_DEBUG to the build to get the step profile of vulcan/AutonProfiler.c on stdout.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+
+#include "sim.h"
+#include "vulcan/AutonomousHelper.h"
+#include "vulcan/LCDDisplays.h"
+
+#define SIM_INITIALIZE_LIMIT		10 // Seconds initialize() may take
+#define SIM_DEFAULT_LIMIT			15
+#define SIM_DEFAULT_LINE			-18.0
+
+static int Selection = -1;
+static unsigned long long AutonomousEnd;
+
+static void simInitialize()
+{
+	initializeIO();
+	initialize();
+}
+
+static void simAutonomous()
+{
+	AutonSelection = Selection;
+	main_menu.execute = Selection;
+	autonomous();
+	AutonomousEnd = Sim.now;
+}
+
+static double simSeconds(struct timespec *start)
+{
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return (end.tv_sec - start->tv_sec) + (end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void simUsage(const char *name)
+{
+	SimPrint(2, "usage: %s [-t trace.csv] [-f flashdir] [-l line]... [-s seconds] [-v] routine\nroutines:", name);
+	for (int i = 0; i < NUMTITLES; i++)
+		SimPrint(2, " \"%s\"", titles[i]);
+	SimPrint(2, "\n");
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	const char *trace = "trace.csv", *flash = "simflash";
+	double limit = SIM_DEFAULT_LIMIT;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (argv[i][0] == '-' && argv[i][1] != '\0' && argv[i][2] == '\0' && strchr("tfls", argv[i][1]) != NULL)
+		{
+			if (i + 1 >= argc)
+				simUsage(argv[0]);
+			const char *value = argv[++i];
+			switch (argv[i - 1][1])
+			{
+				case 't': trace = value; break;
+				case 'f': flash = value; break;
+				case 's': limit = atof(value); break;
+				case 'l':
+					if (Sim.numLines < SIM_MAX_LINES)
+						Sim.lines[Sim.numLines++] = atof(value);
+					break;
+			}
+		}
+		else if (strcmp(argv[i], "-v") == 0)
+			SimVerbose = true;
+		else
+		{
+			for (int n = 0; n < NUMTITLES; n++)
+				if (strcasecmp(argv[i], titles[n]) == 0)
+					Selection = n;
+			if (Selection == -1)
+			{
+				char *end;
+				long n = strtol(argv[i], &end, 10);
+				if (*end == '\0' && n >= 0 && n < NUMTITLES)
+					Selection = n;
+			}
+		}
+	}
+	if (Selection == -1)
+		simUsage(argv[0]);
+	if (Sim.numLines == 0)
+		Sim.lines[Sim.numLines++] = SIM_DEFAULT_LINE;
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	SimFilesSetDirectory(flash);
+	SimPlantInitialize();
+	SimRun(&simInitialize, SIM_INITIALIZE_LIMIT * 1000000ULL);
+
+	// The trace starts with the routine, with the robot where initialize() left it
+	unsigned long long begin = Sim.now;
+	SimTraceOpen(trace);
+	SimRun(&simAutonomous, begin + (unsigned long long)(limit * 1000000));
+	SimTraceSample();
+	SimTraceClose();
+
+	if (AutonomousEnd != 0)
+		SimPrint(1, "%s: finished after %.3f s", titles[Selection], (AutonomousEnd - begin) / 1000000.0);
+	else
+		SimPrint(1, "%s: stopped at the %.1f s limit", titles[Selection], limit);
+	SimPrint(1, " (%.3f s real)\n", simSeconds(&start));
+	SimPrint(1, "pose x %.1f in, y %.1f in, heading %.1f deg; lift %.1f / %.1f\n", Sim.x, Sim.y,
+		Sim.heading * 180 / M_PI, Sim.lift[0], Sim.lift[1]);
+	return AutonomousEnd != 0 ? 0 : 2;
+}
@@ -0,0 +1,228 @@
+/**
+ * @file tools/sim/simplant.c
+ * @author Elliot Berman
+ * @brief Simple models of the Vulcan mecanum base and lift for the host simulator, and the trajectory trace.
+ *
+ * @details Every motor is a first order lag toward a speed proportional to its PWM, with a deadband. Motor polarities
+ *          are taken from ChassisInitialize() and LiftInitialize(), so a positive MotorSet() moves the mechanism the
+ *          way the robot code expects. <br>
+ *          Base: the wheel speeds are mixed back into forward, strafe (with roller slip), and rotation. The chassis
+ *          IMEs are on the front wheels. The IR sensors read a white line when over one of the field lines. <br>
+ *          Lift: each side is driven by its three motors against gravity and stops at the bottom and top, where its
+ *          limit switches close. The quadrature encoders produce edges on their digital pins, calling the interrupt
+ *          handlers the way the Cortex would.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "sim.h"
+#include "vulcan/CortexDefinitions.h"
+
+#define SIM_MOTOR_DEADBAND			10 // PWM below which a motor does not move
+#define SIM_WHEEL_FREE_SPEED		1045 // IME ticks per second of a chassis wheel at full PWM (100 rpm, 627.2 ticks/rev)
+#define SIM_WHEEL_TAU				0.12 // Seconds for a wheel to reach 63% of a new speed
+#define SIM_TICKS_PER_INCH			49.9 // IME ticks per inch of travel with 4 inch wheels
+#define SIM_TICKS_PER_RADIAN		374 // Wheel travel in ticks per radian the chassis turns in place
+#define SIM_STRAFE_EFFICIENCY		0.8 // Fraction of strafe wheel travel which moves the chassis
+#define SIM_IR_FORWARD				6.0 // Position of the IR sensors in inches ahead of the center...
+#define SIM_IR_SIDE					5.0 // ...and to each side
+#define SIM_LINE_HALF_WIDTH			0.75 // Inches
+#define SIM_IR_LINE					150 // Analog reading over a white line...
+#define SIM_IR_TILE					2800 // ...and over a grey tile
+#define SIM_LIFT_FREE_SPEED			130.0 // Lift encoder ticks per second at full PWM, unloaded
+#define SIM_LIFT_GRAVITY			18 // PWM the lift needs to hold itself up
+#define SIM_LIFT_TAU				0.08
+#define SIM_LIFT_TOP				150.0 // Height of the top limit switches
+#define SIM_LIFT_IME_RATIO			2.0 // Lift IME ticks per encoder tick
+#define SIM_TRACE_PERIOD			10000 // Microseconds between trace rows
+
+/**
+ * @brief Direction the mechanism moves for a positive raw motor value, by port (see MotorConfigure())
+ */
+static const int Polarity[11] = {
+	[MOTOR_CHASSIS_FRONTLEFT] = 1, [MOTOR_CHASSIS_FRONTRIGHT] = 1,
+	[MOTOR_CHASSIS_REARLEFT] = -1, [MOTOR_CHASSIS_REARRIGHT] = -1,
+	[MOTOR_LIFT_FRONTLEFT] = 1, [MOTOR_LIFT_REARLEFT] = 1, [MOTOR_LIFT_MIDDLELEFT] = -1,
+	[MOTOR_LIFT_FRONTRIGHT] = -1, [MOTOR_LIFT_REARRIGHT] = -1, [MOTOR_LIFT_MIDDLERIGHT] = -1,
+};
+
+/**
+ * @brief Quadrature states (top << 1 | bottom) in the order that counts up
+ */
+static const unsigned char Quadrature[4] = { 0, 1, 3, 2 };
+
+static int TraceFile = -1;
+static unsigned long long NextTrace;
+
+static double simMotor(int port)
+{
+	int pwm = Sim.motors[port] * Polarity[port];
+	return abs(pwm) < SIM_MOTOR_DEADBAND ? 0 : pwm / 127.0;
+}
+
+/**
+ * @brief Sets a digital input, calling its interrupt handler if it changed
+ */
+static void simSetPin(unsigned char pin, bool value)
+{
+	if (Sim.pins[pin] == value)
+		return;
+	Sim.pins[pin] = value;
+	if (Sim.interrupts[pin] != NULL)
+		Sim.interrupts[pin](pin);
+}
+
+static void simStepEncoder(int side, unsigned char top, unsigned char bottom)
+{
+	int target = (int)Sim.lift[side];
+	while (Sim.liftCount[side] != target)
+	{
+		Sim.liftCount[side] += Sim.liftCount[side] < target ? 1 : -1;
+		unsigned char state = Quadrature[Sim.liftCount[side] & 3];
+		// Only one channel changes per step
+		simSetPin(top, state & 2);
+		simSetPin(bottom, state & 1);
+	}
+}
+
+static int simIR(double forward, double side)
+{
+	double x = Sim.x + forward * cos(Sim.heading) - side * sin(Sim.heading);
+	for (int i = 0; i < Sim.numLines; i++)
+		if (fabs(x - Sim.lines[i]) < SIM_LINE_HALF_WIDTH)
+			return SIM_IR_LINE;
+	return SIM_IR_TILE;
+}
+
+/**
+ * @brief Puts the robot at the origin with the lift down
+ */
+void SimPlantInitialize()
+{
+	for (int pin = 1; pin < SIM_NUM_PINS; pin++)
+		Sim.pins[pin] = HIGH; // Limit switches open, jumper out
+	Sim.pins[DIG_LIFT_BOTLIM_LEFT] = LOW;
+	Sim.pins[DIG_LIFT_BOTLIM_RIGHT] = LOW;
+	Sim.pins[DIG_LIFT_ENC_LEFT_TOP] = Sim.pins[DIG_LIFT_ENC_LEFT_BOT] = LOW;
+	Sim.pins[DIG_LIFT_ENC_RIGHT_TOP] = Sim.pins[DIG_LIFT_ENC_RIGHT_BOT] = LOW;
+	Sim.analog[ANA_POWEREXP] = 546;
+	Sim.analog[ANA_IR_LEFT] = Sim.analog[ANA_IR_RIGHT] = SIM_IR_TILE;
+}
+
+/**
+ * @brief Advances the plant
+ *
+ * @param dt
+ *			Seconds
+ */
+void SimPlantStep(double dt)
+{
+	// ---------------- BASE ---------------- //
+	const int ports[4] = { MOTOR_CHASSIS_FRONTRIGHT, MOTOR_CHASSIS_REARRIGHT, MOTOR_CHASSIS_FRONTLEFT,
+		MOTOR_CHASSIS_REARLEFT };
+	for (int i = 0; i < 4; i++)
+		Sim.wheels[i] += (simMotor(ports[i]) * SIM_WHEEL_FREE_SPEED - Sim.wheels[i]) * dt / SIM_WHEEL_TAU;
+	double fr = Sim.wheels[0], rr = Sim.wheels[1], fl = Sim.wheels[2], rl = Sim.wheels[3];
+	// Inverse of ChassisSetHolonomic()
+	double forward = (fr + rr + fl + rl) / 4, strafe = (-fr + rr + fl - rl) / 4, rotation = (fr + rr - fl - rl) / 4;
+	strafe *= SIM_STRAFE_EFFICIENCY;
+	double heading = Sim.heading + rotation / SIM_TICKS_PER_RADIAN * dt / 2;
+	Sim.x += (forward * cos(heading) - strafe * sin(heading)) / SIM_TICKS_PER_INCH * dt;
+	Sim.y += (forward * sin(heading) + strafe * cos(heading)) / SIM_TICKS_PER_INCH * dt;
+	Sim.heading += rotation / SIM_TICKS_PER_RADIAN * dt;
+
+	// See ChassisGetIMELeft() and ChassisGetIMERight()
+	Sim.imes[I2C_MOTOR_CHASSIS_LEFT] += fl * dt;
+	Sim.imes[I2C_MOTOR_CHASSIS_RIGHT] -= fr * dt;
+	Sim.imeVelocities[I2C_MOTOR_CHASSIS_LEFT] = fl;
+	Sim.imeVelocities[I2C_MOTOR_CHASSIS_RIGHT] = -fr;
+
+	Sim.analog[ANA_IR_LEFT] = simIR(SIM_IR_FORWARD, SIM_IR_SIDE);
+	Sim.analog[ANA_IR_RIGHT] = simIR(SIM_IR_FORWARD, -SIM_IR_SIDE);
+
+	// ---------------- LIFT ---------------- //
+	const int sides[2][3] = {
+		{ MOTOR_LIFT_FRONTLEFT, MOTOR_LIFT_MIDDLELEFT, MOTOR_LIFT_REARLEFT },
+		{ MOTOR_LIFT_FRONTRIGHT, MOTOR_LIFT_MIDDLERIGHT, MOTOR_LIFT_REARRIGHT }
+	};
+	for (int side = 0; side < 2; side++)
+	{
+		double power = (simMotor(sides[side][0]) + simMotor(sides[side][1]) + simMotor(sides[side][2])) / 3;
+		power -= SIM_LIFT_GRAVITY / 127.0;
+		// Friction holds the lift still near the holding power
+		if (fabs(power) < SIM_MOTOR_DEADBAND / 127.0)
+			power = 0;
+		Sim.liftSpeed[side] += (power * SIM_LIFT_FREE_SPEED - Sim.liftSpeed[side]) * dt / SIM_LIFT_TAU;
+		Sim.lift[side] += Sim.liftSpeed[side] * dt;
+		if (Sim.lift[side] <= 0 || Sim.lift[side] >= SIM_LIFT_TOP)
+		{
+			Sim.lift[side] = Sim.lift[side] <= 0 ? 0 : SIM_LIFT_TOP;
+			Sim.liftSpeed[side] = 0;
+		}
+	}
+	simSetPin(DIG_LIFT_BOTLIM_LEFT, Sim.lift[0] > 0.5);
+	simSetPin(DIG_LIFT_TOPLIM_LEFT, Sim.lift[0] < SIM_LIFT_TOP - 0.5);
+	simSetPin(DIG_LIFT_BOTLIM_RIGHT, Sim.lift[1] > 0.5);
+	simSetPin(DIG_LIFT_TOPLIM_RIGHT, Sim.lift[1] < SIM_LIFT_TOP - 0.5);
+	simStepEncoder(0, DIG_LIFT_ENC_LEFT_TOP, DIG_LIFT_ENC_LEFT_BOT);
+	simStepEncoder(1, DIG_LIFT_ENC_RIGHT_TOP, DIG_LIFT_ENC_RIGHT_BOT);
+
+	// See LiftGetRawIMELeft() and LiftGetRawIMERight()
+	Sim.imes[I2C_MOTOR_LIFT_LEFT] = Sim.lift[0] * SIM_LIFT_IME_RATIO;
+	Sim.imes[I2C_MOTOR_LIFT_RIGHT] = -Sim.lift[1] * SIM_LIFT_IME_RATIO;
+	Sim.imeVelocities[I2C_MOTOR_LIFT_LEFT] = Sim.liftSpeed[0] * SIM_LIFT_IME_RATIO;
+	Sim.imeVelocities[I2C_MOTOR_LIFT_RIGHT] = -Sim.liftSpeed[1] * SIM_LIFT_IME_RATIO;
+
+	if (TraceFile >= 0 && Sim.now >= NextTrace)
+	{
+		SimTraceSample();
+		NextTrace += SIM_TRACE_PERIOD;
+	}
+}
+
+/**
+ * @brief Starts writing the trajectory trace (CSV) to a host file
+ */
+void SimTraceOpen(const char *path)
+{
+	TraceFile = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (TraceFile < 0)
+	{
+		SimPrint(2, "cannot write %s\n", path);
+		return;
+	}
+	SimPrint(TraceFile, "time,x,y,heading,liftLeft,liftRight,claw,needle");
+	for (int port = 1; port <= 10; port++)
+		SimPrint(TraceFile, ",motor%d", port);
+	SimPrint(TraceFile, "\n");
+	NextTrace = Sim.now;
+}
+
+/**
+ * @brief Writes one row of the trace: time in seconds, pose in inches and degrees, lift heights, pneumatics, and raw
+ *        motor values
+ */
+void SimTraceSample()
+{
+	SimPrint(TraceFile, "%.3f,%.2f,%.2f,%.1f,%.1f,%.1f,%d,%d", Sim.now / 1000000.0, Sim.x, Sim.y,
+		Sim.heading * 180 / M_PI, Sim.lift[0], Sim.lift[1], Sim.outputs[DIG_SCORINGMECH_CLAW],
+		Sim.outputs[DIG_SCORINGMECH_NEEDLE]);
+	for (int port = 1; port <= 10; port++)
+		SimPrint(TraceFile, ",%d", Sim.motors[port]);
+	SimPrint(TraceFile, "\n");
+}
+
+void SimTraceClose()
+{
+	if (TraceFile >= 0)
+		close(TraceFile);
+	TraceFile = -1;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file tools/telemetry2csv.c
+ * @author Elliot Berman
+ * @brief Host decoder for the binary telemetry recorded by dummy/recorder.c.
+ *
+ * @details Reads a recording (RECORDER_FILE, or a capture of recorderDump() on the PC debug terminal, where anything
+ *          before the header is skipped) and writes one CSV line per record, with the columns of the old CSV
+ *          recorder. Gaps left by dropped samples are reported on stderr. Build and run on the host with
+ * @code
+ *		gcc -std=gnu99 -O2 -Iinclude -o telemetry2csv tools/telemetry2csv.c
+ *		stty -F /dev/ttyACM0 115200 raw && timeout 20 cat /dev/ttyACM0 > trial.bin
+ *		./telemetry2csv trial.bin trial.csv
+ * @endcode
+ *          Without an output file the CSV goes to stdout, without an input file the recording is read from stdin.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+// Only the definitions of the format are needed, not the PROS API included by main.h
+#define MAIN_H_
+#include "dummy/recorder.h"
+
+// Fields are read byte by byte, so the layout does not depend on the padding of the host
+#define TELEMETRY_RECORD_SIZE		(4 + RECORDER_NUM_IMES * (4 + 2))
+
+static long telemetryGet(const unsigned char *bytes, int size)
+{
+	unsigned long value = 0;
+	for (int i = size - 1; i >= 0; i--)
+		value = (value << 8) | bytes[i];
+	if (size < 4 && (value & (1UL << (size * 8 - 1))))
+		return (long)value - (1L << (size * 8)); // Sign extend
+	return size == 4 ? (long)(int32_t)value : (long)value;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc > 3)
+	{
+		fprintf(stderr, "usage: %s [recording [output.csv]]\n", argv[0]);
+		return 1;
+	}
+	FILE *in = argc > 1 ? fopen(argv[1], "rb") : stdin;
+	FILE *out = argc > 2 ? fopen(argv[2], "w") : stdout;
+	if (in == NULL || out == NULL)
+	{
+		perror(in == NULL ? argv[1] : argv[2]);
+		return 1;
+	}
+
+	// Synchronize on the magic
+	int byte, previous = EOF;
+	while ((byte = fgetc(in)) != EOF && !(previous == 'T' && byte == 'L'))
+		previous = byte;
+	unsigned char header[RECORDER_HEADER_SIZE - 2];
+	if (byte == EOF || fread(header, 1, sizeof(header), in) != sizeof(header))
+	{
+		fprintf(stderr, "no recording found\n");
+		return 1;
+	}
+	if (header[0] != RECORDER_VERSION || header[1] != RECORDER_NUM_IMES)
+	{
+		fprintf(stderr, "recording version %d with %d IMEs, expected version %d with %d\n", header[0], header[1],
+			RECORDER_VERSION, RECORDER_NUM_IMES);
+		return 1;
+	}
+	unsigned int period = header[2] | (header[3] << 8);
+
+	fprintf(out, "curr_time");
+	for (int i = 0; i < RECORDER_NUM_IMES; i++)
+		fprintf(out, ",imeCount[%d],imeVelocity[%d]", i, i);
+	fprintf(out, "\n");
+
+	unsigned char record[TELEMETRY_RECORD_SIZE];
+	unsigned long records = 0, gaps = 0;
+	long last = -1;
+	while (fread(record, 1, TELEMETRY_RECORD_SIZE, in) == TELEMETRY_RECORD_SIZE)
+	{
+		long time = telemetryGet(record, 4);
+		fprintf(out, "%ld", time);
+		for (int i = 0; i < RECORDER_NUM_IMES; i++)
+			fprintf(out, ",%ld,%ld", telemetryGet(record + 4 + i * 4, 4),
+				telemetryGet(record + 4 + RECORDER_NUM_IMES * 4 + i * 2, 2));
+		fprintf(out, "\n");
+		if (last >= 0 && period > 0 && time - last > (long)(period * 3 / 2))
+		{
+			fprintf(stderr, "gap of %ld ms at %ld ms\n", time - last, last);
+			gaps++;
+		}
+		last = time;
+		records++;
+	}
+	fprintf(stderr, "%lu records every %u ms, %lu gaps\n", records, period, gaps);
+	if (out != stdout)
+		fclose(out);
+	return 0;
+}
@@ -0,0 +1,331 @@
+/**
+ * @file vulcan/AutonCommands.c
+ * @author Elliot Berman
+ * @brief Commands for the command scheduler which wrap the lift, chassis, and scoring mechanism functions.
+ *
+ * @details Each command does what the matching blocking function does (LiftGoToHeightCompletion(),
+ *          ChassisGoToGoalCompletion(), a ChassisSet() followed by a delay(), ...) but in polls, so it can run in a
+ *          group alongside others. See libsml/CommandScheduler.c.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#include "main.h"
+#include "sml/CommandScheduler.h"
+
+#include "vulcan/AutonCommands.h"
+#include "vulcan/Chassis.h"
+#include "vulcan/CortexDefinitions.h"
+#include "vulcan/Lift.h"
+#include "vulcan/ScoringMechanism.h"
+
+// ---------------- LIFT ---------------- //
+static void liftToHeightInitialize(Command *command)
+{
+	if (command->args[0] == 0)
+		LiftSet(-100, false); // Like LiftGoToHeightCompletion(0), drive down to the limit switch
+	else
+		LiftGoToHeightContinuous(command->args[0]);
+}
+
+static bool liftToHeightExecute(Command *command)
+{
+	if (command->args[0] == 0)
+		return digitalRead(DIG_LIFT_BOTLIM_LEFT) == LOW;
+	return LiftGoToHeightContinuous(command->args[0]);
+}
+
+static void liftToHeightEnd(Command *command, bool interrupted)
+{
+	if (command->args[0] == 0 || interrupted)
+		LiftSet(0, false);
+}
+
+/**
+ * @brief Returns a command which moves the lift to a height and finishes once it is there
+ *
+ * @param height
+ *			The height, 0 drives down to the bottom limit switch
+ */
+Command LiftCommandToHeight(int height)
+{
+	Command command = { .type = CommandBasic, .Initialize = &liftToHeightInitialize, .Execute = &liftToHeightExecute,
+		.End = &liftToHeightEnd, .args = { height }, .name = "lift" };
+	return command;
+}
+
+static void liftSetHeightInitialize(Command *command)
+{
+	LiftGoToHeightContinuous(command->args[0]);
+}
+
+/**
+ * @brief Returns a command which sets the goal height of the lift and finishes right away, like
+ *        LiftGoToHeightContinuous()
+ */
+Command LiftCommandSetHeight(int height)
+{
+	Command command = { .type = CommandBasic, .Initialize = &liftSetHeightInitialize, .args = { height },
+		.name = "lift set" };
+	return command;
+}
+
+static void liftTrajectoryInitialize(Command *command)
+{
+	LiftFollowTrajectory(command->data);
+}
+
+static bool liftTrajectoryExecute(Command *command)
+{
+	return LiftFollowTrajectoryContinuous(command->data);
+}
+
+static void liftTrajectoryEnd(Command *command, bool interrupted)
+{
+	if (interrupted)
+		LiftSet(0, false);
+}
+
+/**
+ * @brief Returns a command which moves the lift along a trajectory and finishes once the lift is on its target
+ *
+ * @param trajectory
+ *			From LiftTrajectoryCompute(), must outlive the command
+ */
+Command LiftCommandFollowTrajectory(const LiftTrajectory *trajectory)
+{
+	Command command = { .type = CommandBasic, .Initialize = &liftTrajectoryInitialize,
+		.Execute = &liftTrajectoryExecute, .End = &liftTrajectoryEnd, .args = { trajectory->target },
+		.data = trajectory, .name = "lift trajectory" };
+	return command;
+}
+
+// ---------------- CHASSIS ---------------- //
+static bool chassisToGoalExecute(Command *command)
+{
+	if (ChassisIMEsDegraded())
+		return true; // ChassisGoToGoalContinuous() has stopped the chassis
+	if (ChassisGoToGoalContinuous(command->args[0], command->args[1]))
+		command->count++;
+	return command->count * COMMAND_SCHEDULER_DELTAT >= CHASSIS_COMMAND_SETTLE;
+}
+
+static void chassisStopEnd(Command *command, bool interrupted)
+{
+	ChassisSet(0, 0, false);
+}
+
+static void chassisToGoalEnd(Command *command, bool interrupted)
+{
+	if (interrupted)
+		ChassisSet(0, 0, false);
+}
+
+/**
+ * @brief Returns a command which drives the chassis PID controllers to IME goals, like ChassisGoToGoalCompletion()
+ *
+ * @param left
+ *			Goal of the left side
+ *
+ * @param right
+ *			Goal of the right side
+ */
+Command ChassisCommandToGoal(int left, int right)
+{
+	Command command = { .type = CommandBasic, .Execute = &chassisToGoalExecute, .End = &chassisToGoalEnd,
+		.args = { left, right }, .name = "chassis" };
+	return command;
+}
+
+static void chassisSetInitialize(Command *command)
+{
+	ChassisSet(command->args[0], command->args[1], false);
+}
+
+static bool chassisTimedExecute(Command *command)
+{
+	return millis() - command->startTime >= (unsigned long)command->args[2];
+}
+
+/**
+ * @brief Returns a command which drives the chassis open loop for a while, then stops it
+ *
+ * @param left
+ *			[-127,127] Speed of the left side
+ *
+ * @param right
+ *			[-127,127] Speed of the right side
+ *
+ * @param duration
+ *			Milliseconds to drive
+ */
+Command ChassisCommandSet(int left, int right, unsigned long duration)
+{
+	Command command = { .type = CommandBasic, .Initialize = &chassisSetInitialize, .Execute = &chassisTimedExecute,
+		.End = &chassisStopEnd, .args = { left, right, (int)duration }, .name = "drive" };
+	return command;
+}
+
+static void chassisMecanumInitialize(Command *command)
+{
+	ChassisSetMecanum(command->value, command->args[0], command->args[1], false);
+}
+
+/**
+ * @brief Returns a command which drives the chassis with ChassisSetMecanum() for a while, then stops it
+ *
+ * @param heading
+ *			Direction in radians, see ChassisSetMecanum()
+ *
+ * @param speed
+ *			[-127,127] Speed of the chassis
+ *
+ * @param rotation
+ *			[-127,127] Rotation of the chassis
+ *
+ * @param duration
+ *			Milliseconds to drive
+ */
+Command ChassisCommandMecanum(double heading, int speed, int rotation, unsigned long duration)
+{
+	Command command = { .type = CommandBasic, .Initialize = &chassisMecanumInitialize, .Execute = &chassisTimedExecute,
+		.End = &chassisStopEnd, .args = { speed, rotation, (int)duration }, .value = heading, .name = "mecanum" };
+	return command;
+}
+
+static void chassisDriveUntilInitialize(Command *command)
+{
+	ChassisSet(command->args[0], command->args[1], false);
+	ChassisUntilStart(command->data);
+}
+
+static bool chassisUntilExecute(Command *command)
+{
+	return ChassisUntilContinuous(NULL);
+}
+
+/**
+ * @brief Returns a command which drives the chassis open loop until a condition holds, like ChassisDriveUntil()
+ *
+ * @param left
+ *			[-127,127] Speed of the left side
+ *
+ * @param right
+ *			[-127,127] Speed of the right side
+ *
+ * @param until
+ *			Conditions which end the move, must outlive the command
+ */
+Command ChassisCommandDriveUntil(int left, int right, const ChassisUntil *until)
+{
+	Command command = { .type = CommandBasic, .Initialize = &chassisDriveUntilInitialize,
+		.Execute = &chassisUntilExecute, .End = &chassisToGoalEnd, .args = { left, right }, .data = until,
+		.name = "drive until" };
+	return command;
+}
+
+static void chassisMecanumUntilInitialize(Command *command)
+{
+	ChassisSetMecanum(command->value, command->args[0], command->args[1], false);
+	ChassisUntilStart(command->data);
+}
+
+/**
+ * @brief Returns a command which drives the chassis with ChassisSetMecanum() until a condition holds, like
+ *        ChassisMecanumUntil()
+ *
+ * @param heading
+ *			Direction in radians, see ChassisSetMecanum()
+ *
+ * @param speed
+ *			[-127,127] Speed of the chassis
+ *
+ * @param rotation
+ *			[-127,127] Rotation of the chassis
+ *
+ * @param until
+ *			Conditions which end the move, must outlive the command
+ */
+Command ChassisCommandMecanumUntil(double heading, int speed, int rotation, const ChassisUntil *until)
+{
+	Command command = { .type = CommandBasic, .Initialize = &chassisMecanumUntilInitialize,
+		.Execute = &chassisUntilExecute, .End = &chassisToGoalEnd, .args = { speed, rotation }, .value = heading,
+		.data = until, .name = "mecanum until" };
+	return command;
+}
+
+static void chassisAlignInitialize(Command *command)
+{
+	ChassisAlignToLineStart(command->args[0], command->args[1], (kTiles)command->args[2]);
+}
+
+static bool chassisAlignExecute(Command *command)
+{
+	return ChassisAlignToLineContinuous();
+}
+
+/**
+ * @brief Returns a command which aligns the chassis to a line, like ChassisAlignToLine()
+ *
+ * @param left
+ *			The initial motor speed for the left side of the chassis
+ *
+ * @param right
+ *			The intial motor speed for the right side of the chassis
+ *
+ * @param tile
+ *			The tile that the line is detected on
+ */
+Command ChassisCommandAlignToLine(int left, int right, kTiles tile)
+{
+	Command command = { .type = CommandBasic, .Initialize = &chassisAlignInitialize, .Execute = &chassisAlignExecute,
+		.End = &chassisToGoalEnd, .args = { left, right, tile }, .name = "align" };
+	return command;
+}
+
+static void chassisResetIMEsInitialize(Command *command)
+{
+	ChassisResetIMEs();
+}
+
+/**
+ * @brief Returns a command which resets the chassis IMEs and finishes right away
+ */
+Command ChassisCommandResetIMEs()
+{
+	Command command = { .type = CommandBasic, .Initialize = &chassisResetIMEsInitialize, .name = "reset IMEs" };
+	return command;
+}
+
+// ---------------- SCORING MECHANISM ---------------- //
+static void clawInitialize(Command *command)
+{
+	ScoringMechClawSet(command->args[0]);
+}
+
+/**
+ * @brief Returns a command which sets the claw and finishes right away
+ */
+Command ScoringMechCommandClaw(bool value)
+{
+	Command command = { .type = CommandBasic, .Initialize = &clawInitialize, .args = { value }, .name = "claw" };
+	return command;
+}
+
+static void needleInitialize(Command *command)
+{
+	ScoringMechNeedleSet(command->args[0]);
+}
+
+/**
+ * @brief Returns a command which sets the needle and finishes right away
+ */
+Command ScoringMechCommandNeedle(bool value)
+{
+	Command command = { .type = CommandBasic, .Initialize = &needleInitialize, .args = { value }, .name = "needle" };
+	return command;
+}
@@ -0,0 +1,279 @@
+/**
+ * @file vulcan/AutonProfiler.c
+ * @author Elliot Berman
+ * @brief Records how long each step of an autonomous routine took against how long it was planned to take.
+ *
+ * @details Under AUTO_DEBUG, vulcan/auto.c routes its delay(), LiftGoToHeightCompletion(),
+ *          ChassisGoToGoalCompletion(), ChassisDriveUntil(), and ChassisMecanumUntil() calls through the Profiled*
+ *          functions here (see AutonProfiler.h), which timestamp them with micros(). A delay is planned to take its own length, a move the distance to its goal
+ *          at PROFILER_LIFT_RATE or PROFILER_CHASSIS_RATE. <br>
+ *          Routines built on the command scheduler are profiled through its observer: every basic command is a step,
+ *          named after what it does. Commands built outside of auto.c (e.g. by a script) show line 0. <br>
+ *          autonomous() dumps the breakdown to the PC debug terminal and saves it to PROFILER_FILE, one step per line,
+ *          followed by the time spent outside of profiled steps.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#include <math.h>
+#include <string.h>
+
+#include "main.h"
+#include "sml/CommandScheduler.h"
+
+#include "vulcan/AutonProfiler.h"
+#include "vulcan/Chassis.h"
+#include "vulcan/Lift.h"
+#include "vulcan/PathFollower.h"
+
+#define PROFILER_LINE_SIZE			96
+
+static ProfileStep Steps[PROFILER_MAX_STEPS];
+static int NumSteps;
+static unsigned long Start;
+/**
+ * @brief Steps which did not fit in Steps
+ */
+static int Dropped;
+
+static void profilerCommandObserver(Command *, bool);
+
+/**
+ * @brief Clears the recorded steps and starts the clock. Call at the start of autonomous.
+ */
+void ProfilerReset()
+{
+	NumSteps = 0;
+	Dropped = 0;
+	Start = micros();
+	CommandSetObserver(&profilerCommandObserver);
+}
+
+/**
+ * @brief Records the start of a step
+ *
+ * @param name
+ *			Name of the step, must be a literal
+ *
+ * @param line
+ *			Source line of the step
+ *
+ * @param argument
+ *			Argument to show with the step
+ *
+ * @param planned
+ *			Microseconds the step should take
+ *
+ * @returns Returns the index to pass to ProfilerEnd(), -1 if there is no room left
+ */
+int ProfilerBegin(const char *name, int line, int argument, unsigned long planned)
+{
+	if (NumSteps >= PROFILER_MAX_STEPS)
+	{
+		Dropped++;
+		return -1;
+	}
+	ProfileStep *step = &Steps[NumSteps];
+	step->name = name;
+	step->line = line;
+	step->argument = argument;
+	step->planned = planned;
+	step->actual = 0;
+	step->start = micros() - Start;
+	return NumSteps++;
+}
+
+/**
+ * @brief Records the end of a step started by ProfilerBegin()
+ */
+void ProfilerEnd(int index)
+{
+	if (index >= 0 && index < NumSteps)
+		Steps[index].actual = micros() - Start - Steps[index].start;
+}
+
+/**
+ * @brief Writes the breakdown of the recorded steps as CSV (times in milliseconds). Lines are formatted with
+ *        snprintf() and written with fputs() so the same code writes to a UART and to a file.
+ *
+ * @param stream
+ *			Where to write, e.g. stdout for the PC debug terminal
+ */
+void ProfilerDump(FILE *stream)
+{
+	char line[PROFILER_LINE_SIZE];
+	// Commands in a group overlap, so only the time covered by at least one step counts as profiled
+	unsigned long total = micros() - Start, profiled = 0, covered = 0, over = 0;
+	fputs("line,step,argument,start,planned,actual,over\r\n", stream);
+	for (int i = 0; i < NumSteps; i++)
+	{
+		ProfileStep *step = &Steps[i];
+		long late = (long)step->actual - (long)step->planned;
+		snprintf(line, sizeof(line), "%d,%s,%d,%lu,%lu,%lu,%ld\r\n", step->line, step->name, step->argument,
+			step->start / 1000, step->planned / 1000, step->actual / 1000, late / 1000);
+		fputs(line, stream);
+		unsigned long end = step->start + step->actual;
+		if (end > covered)
+		{
+			profiled += end - (step->start > covered ? step->start : covered);
+			covered = end;
+		}
+		if (late > 0)
+			over += late;
+	}
+	snprintf(line, sizeof(line), "total %lu ms, %lu ms outside steps, %lu ms over plan, %d steps dropped\r\n",
+		total / 1000, (total - profiled) / 1000, over / 1000, Dropped);
+	fputs(line, stream);
+}
+
+/**
+ * @brief Saves the breakdown to PROFILER_FILE, replacing the previous one
+ *
+ * @returns Returns false if the file could not be opened
+ */
+bool ProfilerSave()
+{
+	fdelete(PROFILER_FILE);
+	FILE *file = fopen(PROFILER_FILE, "w");
+	if (file == NULL)
+		return false;
+	ProfilerDump(file);
+	fclose(file);
+	return true;
+}
+
+/**
+ * @brief delay() recorded as a step
+ */
+void ProfiledDelay(unsigned long time, int line)
+{
+	int index = ProfilerBegin("delay", line, time, time * 1000);
+	delay(time);
+	ProfilerEnd(index);
+}
+
+/**
+ * @brief LiftGoToHeightCompletion() recorded as a step
+ */
+void ProfiledLiftGoToHeightCompletion(int value, int line)
+{
+	unsigned long distance = abs(value - LiftGetQuadEncLeft());
+	int index = ProfilerBegin("lift", line, value, distance * 1000000 / PROFILER_LIFT_RATE);
+	LiftGoToHeightCompletion(value);
+	ProfilerEnd(index);
+}
+
+/**
+ * @brief ChassisGoToGoalCompletion() recorded as a step. The argument shown is the left goal.
+ */
+void ProfiledChassisGoToGoalCompletion(int left, int right, int line)
+{
+	unsigned long distance = abs(left - ChassisGetIMELeft());
+	if ((unsigned long)abs(right - ChassisGetIMERight()) > distance)
+		distance = abs(right - ChassisGetIMERight());
+	int index = ProfilerBegin("chassis", line, left,
+		distance * 1000000 / PROFILER_CHASSIS_RATE + PROFILER_CHASSIS_SETTLE * 1000);
+	ChassisGoToGoalCompletion(left, right);
+	ProfilerEnd(index);
+}
+
+/**
+ * @brief Planned microseconds of a ChassisDriveUntil() or ChassisMecanumUntil(): its distance at the expected
+ *        speed, or its timeout if it has no distance
+ */
+static unsigned long profilerUntilPlanned(const ChassisUntil *until)
+{
+	if (until->distance > 0)
+		return (unsigned long)until->distance * 1000000 / PROFILER_CHASSIS_RATE;
+	return until->timeout * 1000;
+}
+
+/**
+ * @brief ChassisDriveUntil() recorded as a step. The argument shown is the distance.
+ */
+kChassisStop ProfiledChassisDriveUntil(int left, int right, const ChassisUntil *until, int line)
+{
+	int index = ProfilerBegin("drive until", line, until->distance, profilerUntilPlanned(until));
+	kChassisStop stop = ChassisDriveUntil(left, right, until);
+	ProfilerEnd(index);
+	return stop;
+}
+
+/**
+ * @brief ChassisMecanumUntil() recorded as a step. The argument shown is the distance.
+ */
+kChassisStop ProfiledChassisMecanumUntil(double heading, int speed, int rotation, const ChassisUntil *until, int line)
+{
+	int index = ProfilerBegin("mecanum until", line, until->distance, profilerUntilPlanned(until));
+	kChassisStop stop = ChassisMecanumUntil(heading, speed, rotation, until);
+	ProfilerEnd(index);
+	return stop;
+}
+
+/**
+ * @brief Returns the planned microseconds of a command as it starts, like those of the blocking functions it wraps,
+ *        and sets argument to what is shown with it
+ */
+static unsigned long profilerCommandPlanned(Command *command, int *argument)
+{
+	const char *name = command->name;
+	*argument = command->args[0];
+	if (strcmp(name, "lift") == 0)
+		return (unsigned long)abs(command->args[0] - LiftGetQuadEncLeft()) * 1000000 / PROFILER_LIFT_RATE;
+	if (strcmp(name, "chassis") == 0)
+	{
+		unsigned long distance = abs(command->args[0] - ChassisGetIMELeft());
+		if ((unsigned long)abs(command->args[1] - ChassisGetIMERight()) > distance)
+			distance = abs(command->args[1] - ChassisGetIMERight());
+		return distance * 1000000 / PROFILER_CHASSIS_RATE + PROFILER_CHASSIS_SETTLE * 1000;
+	}
+	if (strcmp(name, "lift trajectory") == 0)
+		return (unsigned long)((const LiftTrajectory *)command->data)->numPoints * MASTER_SLAVE_PID_DELTAT * 1000;
+	if (strcmp(name, "drive until") == 0 || strcmp(name, "mecanum until") == 0)
+	{
+		*argument = ((const ChassisUntil *)command->data)->distance;
+		return profilerUntilPlanned(command->data);
+	}
+	if (strcmp(name, "wait") == 0)
+		return (unsigned long)command->args[0] * 1000;
+	if (strcmp(name, "drive") == 0 || strcmp(name, "mecanum") == 0)
+		return (unsigned long)command->args[2] * 1000;
+	if (strcmp(name, "path") == 0)
+	{
+		const Path *path = command->data;
+		double length = 0;
+		for (int i = 1; i < path->numPoints; i++)
+			length += hypot(path->points[i].x - path->points[i - 1].x, path->points[i].y - path->points[i - 1].y);
+		return (unsigned long)(length * 1000000 / PROFILER_CHASSIS_RATE);
+	}
+	return 0;
+}
+
+/**
+ * @brief Records every basic command run by the command scheduler as a step
+ */
+static void profilerCommandObserver(Command *command, bool finished)
+{
+	if (finished)
+	{
+		ProfilerEnd(command->tag);
+		return;
+	}
+	int argument;
+	unsigned long planned = command->name != NULL ? profilerCommandPlanned(command, &argument) : 0;
+	command->tag = ProfilerBegin(command->name != NULL ? command->name : "command", command->line,
+		command->name != NULL ? argument : command->args[0], planned);
+}
+
+/**
+ * @brief Records the line a command was built on, so its step shows it
+ */
+Command ProfiledCommand(Command command, int line)
+{
+	command.line = line;
+	return command;
+}
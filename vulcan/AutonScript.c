@@ -0,0 +1,286 @@
+/**
+ * @file vulcan/AutonScript.c
+ * @author Elliot Berman
+ * @brief Runs autonomous routines written as bytecode scripts and stored in flash, so they can be changed without
+ *        uploading a new program.
+ *
+ * @details Scripts are assembled on a computer by tools/autonasm.c and sent over the programming cable while the
+ *          robot waits in AutonScriptReceive(), which saves them to AUTON_SCRIPT_FILE. <br>
+ *          AutonScriptRun() loads the file, checks it, and builds a tree of commands (see vulcan/AutonCommands.c)
+ *          from the bytecode in static pools, then runs the tree with the command scheduler. A script is a single
+ *          step (the assembler puts everything in a sequence) followed by AutonOpEnd. A script which does not parse is
+ *          not run at all. <br>
+ *          The file holds the AUTON_SCRIPT_HEADER_SIZE byte header, the code, and one byte with the XOR of the code.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#include "main.h"
+#include "lcd/LCDFunctions.h"
+#include "sml/CommandScheduler.h"
+
+#include "vulcan/AutonCommands.h"
+#include "vulcan/AutonScript.h"
+#include "vulcan/Chassis.h"
+#include "vulcan/Lift.h"
+
+#define AUTON_SCRIPT_RECEIVE_TIMEOUT	1000 // Milliseconds without a byte after which a transfer is abandoned
+
+static unsigned char Code[AUTON_SCRIPT_MAX_SIZE];
+static unsigned int Length, Position;
+static Command Commands[AUTON_SCRIPT_MAX_COMMANDS];
+static Command *Children[AUTON_SCRIPT_MAX_COMMANDS];
+static int NumCommands, NumChildren;
+static unsigned long ScriptStart;
+static TaskHandle receiveTaskHandle;
+
+// ---------------- WAIT UNTIL ---------------- //
+static bool untilExecute(Command *command)
+{
+	switch (command->args[0])
+	{
+		case AutonUntilTime:
+			return millis() - ScriptStart >= (unsigned long)command->args[1];
+		case AutonUntilLiftAbove:
+			return LiftGetQuadEncLeft() >= command->args[1];
+		case AutonUntilLiftBelow:
+			return LiftGetQuadEncLeft() <= command->args[1];
+		case AutonUntilLine:
+			return ChassisHasIRLineLeft((kTiles)command->args[1]) || ChassisHasIRLineRight((kTiles)command->args[1]);
+		default:
+			return true;
+	}
+}
+
+// ---------------- PARSER ---------------- //
+static bool scriptGetArg(int *value)
+{
+	if (Position + 2 > Length)
+		return false;
+	*value = (short)(Code[Position] | (Code[Position + 1] << 8));
+	Position += 2;
+	return true;
+}
+
+static bool scriptGetArgs(int *args, int count)
+{
+	for (int i = 0; i < count; i++)
+		if (!scriptGetArg(&args[i]))
+			return false;
+	return true;
+}
+
+/**
+ * @brief Parses one step (and its children, for a group) into the command pools
+ *
+ * @param depth
+ *			Number of groups the step is in. Groups are parsed recursively on the stack of the autonomous task, so
+ *			they may not be nested deeper than AUTON_SCRIPT_MAX_DEPTH.
+ *
+ * @returns Returns the command, or NULL if the code is invalid or too big for the pools
+ */
+static Command *scriptParseStep(int depth)
+{
+	if (Position >= Length || NumCommands >= AUTON_SCRIPT_MAX_COMMANDS)
+		return NULL;
+	Command *command = &Commands[NumCommands++];
+	AutonOp op = (AutonOp)Code[Position++];
+	int args[4];
+
+	switch (op)
+	{
+		case AutonOpDrive:
+			if (!scriptGetArgs(args, 2)) return NULL;
+			*command = ChassisCommandToGoal(args[0], args[1]);
+			break;
+		case AutonOpSet:
+			if (!scriptGetArgs(args, 3)) return NULL;
+			*command = ChassisCommandSet(args[0], args[1], args[2]);
+			break;
+		case AutonOpMecanum:
+			if (!scriptGetArgs(args, 4)) return NULL;
+			*command = ChassisCommandMecanum(args[0] / 1000.0, args[1], args[2], args[3]);
+			break;
+		case AutonOpLift:
+			if (!scriptGetArgs(args, 1)) return NULL;
+			*command = LiftCommandToHeight(args[0]);
+			break;
+		case AutonOpClaw:
+			if (!scriptGetArgs(args, 1)) return NULL;
+			*command = ScoringMechCommandClaw(args[0] != 0);
+			break;
+		case AutonOpNeedle:
+			if (!scriptGetArgs(args, 1)) return NULL;
+			*command = ScoringMechCommandNeedle(args[0] != 0);
+			break;
+		case AutonOpWait:
+			if (!scriptGetArgs(args, 1)) return NULL;
+			*command = CommandWait(args[0]);
+			break;
+		case AutonOpUntil:
+		{
+			if (!scriptGetArgs(args, 3)) return NULL;
+			Command until = { .type = CommandBasic, .Execute = &untilExecute, .args = { args[0], args[1] },
+				.timeout = args[2], .name = "until" };
+			*command = until;
+			break;
+		}
+		case AutonOpReset:
+			*command = ChassisCommandResetIMEs();
+			break;
+		case AutonOpSequence:
+		case AutonOpParallel:
+		case AutonOpRace:
+		case AutonOpDeadline:
+		{
+			if (Position >= Length || depth >= AUTON_SCRIPT_MAX_DEPTH) return NULL;
+			int count = Code[Position++];
+			if (NumChildren + count > AUTON_SCRIPT_MAX_COMMANDS) return NULL;
+			Command group = { .type = CommandSequential + (op - AutonOpSequence), .children = &Children[NumChildren],
+				.numChildren = count };
+			// Reserve the children first so they are contiguous even if they are groups themselves
+			NumChildren += count;
+			for (int i = 0; i < count; i++)
+				if ((group.children[i] = scriptParseStep(depth + 1)) == NULL)
+					return NULL;
+			*command = group;
+			break;
+		}
+		default:
+			return NULL;
+	}
+	return command;
+}
+
+/**
+ * @brief Loads AUTON_SCRIPT_FILE into Code
+ */
+static bool scriptLoad()
+{
+	FILE *file = fopen(AUTON_SCRIPT_FILE, "r");
+	if (file == NULL)
+		return false;
+	unsigned char header[AUTON_SCRIPT_HEADER_SIZE], check = 0, sum;
+	bool valid = (fread(header, 1, AUTON_SCRIPT_HEADER_SIZE, file) == AUTON_SCRIPT_HEADER_SIZE && header[0] == 'A' &&
+		header[1] == 'S' && header[2] == AUTON_SCRIPT_VERSION);
+	Length = header[3] | (header[4] << 8);
+	valid = valid && Length <= AUTON_SCRIPT_MAX_SIZE && fread(Code, 1, Length, file) == Length &&
+		fread(&sum, 1, 1, file) == 1;
+	fclose(file);
+
+	for (unsigned int i = 0; valid && i < Length; i++)
+		check ^= Code[i];
+	return valid && check == sum;
+}
+
+/**
+ * @brief Runs the autonomous script saved in flash
+ *
+ * @returns Returns false if there is no script or it is invalid, in which case nothing was run
+ */
+bool AutonScriptRun()
+{
+	if (!scriptLoad())
+	{
+		lcdprint_d(Centered, 2, 1000, "No script");
+		return false;
+	}
+
+	// The assembler wraps the whole script in one group, which must be followed by the end of the script
+	Position = 0;
+	NumCommands = 0;
+	NumChildren = 0;
+	Command *root = scriptParseStep(0);
+	if (root == NULL || Position >= Length || Code[Position] != AutonOpEnd)
+	{
+		lcdprint_d(Centered, 2, 1000, "Bad script");
+		return false;
+	}
+
+	ScriptStart = millis();
+	CommandRun(root);
+	return true;
+}
+
+/**
+ * @brief Reads one byte from the PC debug terminal
+ *
+ * @returns Returns the byte, or -1 if none arrived within AUTON_SCRIPT_RECEIVE_TIMEOUT
+ */
+static int scriptReceiveByte()
+{
+	unsigned long start = millis();
+	while (fcount(stdin) == 0)
+	{
+		if (millis() - start > AUTON_SCRIPT_RECEIVE_TIMEOUT)
+			return -1;
+		delay(5);
+	}
+	return fgetc(stdin);
+}
+
+/**
+ * @brief Waits for scripts sent over the programming cable and saves each valid one to AUTON_SCRIPT_FILE
+ */
+static void scriptReceiveTask(void *none)
+{
+	unsigned char header[AUTON_SCRIPT_HEADER_SIZE];
+	while (true)
+	{
+		// Synchronize on the magic
+		int byte = scriptReceiveByte();
+		if (byte != 'A' || (byte = scriptReceiveByte()) != 'S')
+			continue;
+		header[0] = 'A';
+		header[1] = 'S';
+		bool valid = true;
+		for (int i = 2; i < AUTON_SCRIPT_HEADER_SIZE && valid; i++)
+		{
+			valid = (byte = scriptReceiveByte()) != -1;
+			header[i] = byte;
+		}
+		unsigned int length = header[3] | (header[4] << 8);
+		valid = valid && header[2] == AUTON_SCRIPT_VERSION && length <= AUTON_SCRIPT_MAX_SIZE;
+
+		unsigned char check = 0;
+		for (unsigned int i = 0; i < length && valid; i++)
+		{
+			valid = (byte = scriptReceiveByte()) != -1;
+			Code[i] = byte;
+			check ^= byte;
+		}
+		valid = valid && scriptReceiveByte() == check;
+		if (!valid)
+		{
+			lcdprint_d(Centered, 2, 1000, "Script rejected");
+			continue;
+		}
+
+		fdelete(AUTON_SCRIPT_FILE);
+		FILE *file = fopen(AUTON_SCRIPT_FILE, "w");
+		if (file == NULL)
+			continue;
+		fwrite(header, 1, AUTON_SCRIPT_HEADER_SIZE, file);
+		fwrite(Code, 1, length, file);
+		fwrite(&check, 1, 1, file);
+		fclose(file);
+		lcdprint_d(Centered, 2, 1000, "Script saved");
+	}
+}
+
+/**
+ * @brief Starts listening for scripts on the PC debug terminal (sent with tools/autonasm.c). Returns immediately.
+ *
+ * @returns Returns false if already listening
+ */
+bool AutonScriptReceive()
+{
+	if (receiveTaskHandle != NULL)
+		return false;
+	receiveTaskHandle = taskCreate(&scriptReceiveTask, TASK_MINIMAL_STACK_SIZE * 2, NULL, TASK_PRIORITY_LOWEST + 1);
+	return true;
+}
@@ -16,10 +16,18 @@
 
 #include "sml/SmartMotorLibrary.h"
 #include "sml/SingleThreadPIDController.h"
+#include "sml/IMEManager.h"
 #include "lcd/LCDFunctions.h"
 #include "vulcan/CortexDefinitions.h"
 
 #define CHASSIS_SKEW_PROFILE	0.75
+#define CHASSIS_ANGLE_UNITS		4096 // Angles in the mixer are in 1/4096 of a turn
+#define CHASSIS_MIX_ONE			16384 // 1.0 in the fixed point mixer
+
+/**
+ * @brief Skew rate of every chassis motor, see ChassisApplyTuning()
+ */
+double ChassisSkewRate = CHASSIS_SKEW_PROFILE;
 
 // ---------------- LEFT  SIDE ---------------- //
 static PIDController leftController;
@@ -46,8 +54,8 @@ void ChassisSetLeft(int speed, bool immediate)
  */
 int ChassisGetIMELeft()
 {
-	int val; 
-	imeGet(I2C_MOTOR_CHASSIS_LEFT, &val);
+	int val;
+	IMEManagerGet(I2C_MOTOR_CHASSIS_LEFT, &val);
 	return val;
 }
 
@@ -106,7 +114,7 @@ void ChassisSetRight(int speed, bool immediate)
 int ChassisGetIMERight()
 {
 	int val;
-	imeGet(I2C_MOTOR_CHASSIS_RIGHT, &val);
+	IMEManagerGet(I2C_MOTOR_CHASSIS_RIGHT, &val);
 	return -val;
 }
 
@@ -175,6 +183,58 @@ void ChassisSet(int left, int right, bool immediate)
 	MotorSet(MOTOR_CHASSIS_REARRIGHT,  right, immediate);
 }
 
+/**
+ * @brief sin() of [0,PI/2] in CHASSIS_MIX_ONE units, one entry every 16 angle units
+ */
+static const short ChassisSinTable[65] = {
+	0, 402, 804, 1205, 1606, 2006, 2404, 2801, 3196, 3590, 3981, 4370, 4756,
+	5139, 5520, 5897, 6270, 6639, 7005, 7366, 7723, 8076, 8423, 8765, 9102, 9434,
+	9760, 10080, 10394, 10702, 11003, 11297, 11585, 11866, 12140, 12406, 12665, 12916, 13160,
+	13395, 13623, 13842, 14053, 14256, 14449, 14635, 14811, 14978, 15137, 15286, 15426, 15557,
+	15679, 15791, 15893, 15986, 16069, 16143, 16207, 16261, 16305, 16340, 16364, 16379, 16384,
+};
+
+/**
+ * @brief Returns the sine of angle in CHASSIS_MIX_ONE units, interpolated from ChassisSinTable
+ *
+ * @param angle
+ *        The angle in 1/CHASSIS_ANGLE_UNITS of a turn
+ */
+static long ChassisSin(long angle)
+{
+	angle &= CHASSIS_ANGLE_UNITS - 1;
+	int quadrant = angle / (CHASSIS_ANGLE_UNITS / 4);
+	int a = angle % (CHASSIS_ANGLE_UNITS / 4);
+	if (quadrant & 1)
+		a = CHASSIS_ANGLE_UNITS / 4 - a;
+	int i = a / 16, f = a % 16;
+	long value = ChassisSinTable[i];
+	if (i < 64)
+		value += (ChassisSinTable[i + 1] - ChassisSinTable[i]) * f / 16;
+	return quadrant >= 2 ? -value : value;
+}
+
+/**
+ * @brief Scales the four wheel speeds down together if any is beyond [-127,127] and sets the motors
+ */
+static void ChassisSetWheels(int frontRight, int rearRight, int frontLeft, int rearLeft, bool immediate)
+{
+	int max = 127;
+	if (abs(frontRight) > max)
+		max = abs(frontRight);
+	if (abs(rearRight) > max)
+		max = abs(rearRight);
+	if (abs(frontLeft) > max)
+		max = abs(frontLeft);
+	if (abs(rearLeft) > max)
+		max = abs(rearLeft);
+
+	MotorSet(MOTOR_CHASSIS_FRONTRIGHT, frontRight * 127 / max, immediate);
+	MotorSet(MOTOR_CHASSIS_REARRIGHT,  rearRight * 127 / max,  immediate);
+	MotorSet(MOTOR_CHASSIS_FRONTLEFT,  frontLeft * 127 / max,  immediate);
+	MotorSet(MOTOR_CHASSIS_REARLEFT,   rearLeft * 127 / max,   immediate);
+}
+
 /**
  * @brief Sets the chassis to go at heading with speed and rotation. See additional
  *        mecanum conversion description in notebook.
@@ -198,31 +258,39 @@ void ChassisSetMecanum(double heading, int speed, int rotation, bool immediate)
 	if (abs(rotation) > 127)
 		rotation = signbit(rotation) ? -127 : 127;
 
-	int rightDiag = speed * cos(heading + (M_PI/4));
-	int leftDiag = speed * cos(heading - (M_PI/4));
-
-	int frontRight = rightDiag + rotation,
-		rearRight = leftDiag + rotation,
-		frontLeft = leftDiag - rotation,
-		rearLeft = rightDiag - rotation;
-
-	int max = 127;
-	if (abs(frontRight) > max)
-		max = abs(frontRight);
-	if (abs(rearRight) > max)
-		max = abs(rearRight);
-	if (abs(frontLeft) > max)
-		max = abs(frontLeft);
-	if (abs(rearLeft) > max)
-		max = abs(rearLeft);
+	// cos(x) = sin(x + PI/2), and PI/4 is an eighth of a turn
+	long angle = (long)(heading * (CHASSIS_ANGLE_UNITS / (2 * M_PI)) + (heading < 0 ? -0.5 : 0.5));
+	int rightDiag = speed * ChassisSin(angle + CHASSIS_ANGLE_UNITS / 4 + CHASSIS_ANGLE_UNITS / 8) / CHASSIS_MIX_ONE;
+	int leftDiag = speed * ChassisSin(angle + CHASSIS_ANGLE_UNITS / 4 - CHASSIS_ANGLE_UNITS / 8) / CHASSIS_MIX_ONE;
 
-	double speedScale = 127.00 / max;
+	ChassisSetWheels(rightDiag + rotation, leftDiag + rotation, leftDiag - rotation, rightDiag - rotation, immediate);
+}
 
-	MotorSet(MOTOR_CHASSIS_FRONTRIGHT, (int)(frontRight * speedScale), immediate);
-	MotorSet(MOTOR_CHASSIS_REARRIGHT,  (int)(rearRight * speedScale),  immediate);
-	MotorSet(MOTOR_CHASSIS_FRONTLEFT,  (int)(frontLeft * speedScale),  immediate);
-	MotorSet(MOTOR_CHASSIS_REARLEFT,   (int)(rearLeft * speedScale),   immediate);
+/**
+ * @brief Drives the chassis from independent forward, strafe, and rotation inputs, so any direction can be mixed
+ *        with any rotation. Uses only integer math. Wheel speeds are scaled down together if any exceeds 127.
+ *
+ * @param forward
+ *        [-127,127] Speed forward
+ * @param strafe
+ *        [-127,127] Speed sideways, in the direction of heading PI/2 for ChassisSetMecanum()
+ * @param rotation
+ *        [-127,127] Rotation with the same sign as ChassisSetMecanum(): positive adds to the right side
+ * @param immediate
+ *        Determines if speed input change is immediate or ramped according to SML
+ */
+void ChassisSetHolonomic(int forward, int strafe, int rotation, bool immediate)
+{
+	ChassisSetWheels(forward - strafe + rotation, forward + strafe + rotation, forward + strafe - rotation,
+		forward - strafe - rotation, immediate);
+}
 
+/**
+ * @brief Returns true if either chassis IME is degraded and the chassis PID Controllers cannot be trusted
+ */
+bool ChassisIMEsDegraded()
+{
+	return IMEManagerIsDegraded(I2C_MOTOR_CHASSIS_LEFT) || IMEManagerIsDegraded(I2C_MOTOR_CHASSIS_RIGHT);
 }
 
 /**
@@ -233,10 +301,17 @@ void ChassisSetMecanum(double heading, int speed, int rotation, bool immediate)
  * @param right
  *		  The right side goal value
  *
- * @returns Returns true if BOTH sides are on target
+ * @returns Returns true if BOTH sides are on target. If the IMEs are degraded, the chassis is stopped and true is
+ *          returned so that autonomous moves on instead of driving on stale counts.
  */
 bool ChassisGoToGoalContinuous(int left, int right)
 {
+	if (ChassisIMEsDegraded())
+	{
+		ChassisSet(0, 0, true);
+		return true;
+	}
+
 	PIDControllerSetGoal(&leftController, left);
 	PIDControllerSetGoal(&rightController, right);
 
@@ -244,6 +319,8 @@ bool ChassisGoToGoalContinuous(int left, int right)
 	return PIDControllerExecuteContinuous(&leftController) & PIDControllerExecuteContinuous(&rightController);
 }
 
+static LCDFormat chassisIMEFormat;
+
 /**
  * @brief Runs to completion of the PID Controllers, with the goal values being the ones in the parameters
  *
@@ -261,24 +338,67 @@ void ChassisGoToGoalCompletion(int left, int right)
 	// Use 1 '&' instead of 2 to force execution of both sides (both right and left side will run) because short-circuiting
 	while (goodCount < 50)
 	{
+		if (ChassisIMEsDegraded())
+		{
+			// Stale counts would make the PID run away, so stop and let the routine continue open loop
+			ChassisSet(0, 0, true);
+			return;
+		}
 		if (PIDControllerExecuteContinuous(&rightController) & PIDControllerExecuteContinuous(&leftController))
 			goodCount++;
-		lcdprintf(Centered, 1, "cl:%04d r:%04d", ChassisGetIMELeft(), ChassisGetIMERight());
+		lcdprintc(Centered, 1, &chassisIMEFormat, ChassisGetIMELeft(), ChassisGetIMERight());
 		delay(5);
 	}
 }
 
+/**
+ * @brief Returns the left side PID controller so its gains can be tuned. Change its gains and call
+ *        ChassisApplyTuning().
+ */
+PIDController *ChassisGetController()
+{
+	return &leftController;
+}
+
+/**
+ * @brief Applies tuned values: copies the left side's gains to the right side and ChassisSkewRate to every chassis
+ *        motor
+ */
+void ChassisApplyTuning()
+{
+	rightController.Kp = leftController.Kp;
+	rightController.Ki = leftController.Ki;
+	rightController.Kd = leftController.Kd;
+
+	MotorChangeSkew(MOTOR_CHASSIS_FRONTLEFT, ChassisSkewRate);
+	MotorChangeSkew(MOTOR_CHASSIS_FRONTRIGHT, ChassisSkewRate);
+	MotorChangeSkew(MOTOR_CHASSIS_REARLEFT, ChassisSkewRate);
+	MotorChangeSkew(MOTOR_CHASSIS_REARRIGHT, ChassisSkewRate);
+}
+
 /**
  * @brief Resets the chassis IMEs
  */
 void ChassisResetIMEs()
 {
-	imeReset(I2C_MOTOR_CHASSIS_LEFT);
-	imeReset(I2C_MOTOR_CHASSIS_RIGHT);
+	IMEManagerReset(I2C_MOTOR_CHASSIS_LEFT);
+	IMEManagerReset(I2C_MOTOR_CHASSIS_RIGHT);
 }
 
+// A chassis does one move at a time, so the state of the moves below is kept here, as PathFollower.c does
+static int AlignLeft, AlignRight;
+static kTiles AlignTile;
+static bool AlignPassedLeft, AlignPassedRight, AlignHadLeft, AlignHadRight;
+static unsigned long AlignLast, AlignOnLine;
+
+static const ChassisUntil *ActiveUntil;
+static unsigned long UntilStart;
+static int UntilLeft, UntilRight;
+static bool UntilHadLine;
+
 /**
- * @brief Aligns robot to a kTile tile intially going provided speeds.
+ * @brief Starts aligning the robot to a kTile line, intially going provided speeds. Call ChassisAlignToLineContinuous()
+ *        until it returns true.
  *
  * @param left
  *			The initial motor speed for the left side of the chassis
@@ -289,42 +409,180 @@ void ChassisResetIMEs()
  * @param tile
  *			The tile that the line is detected on
  */
-void ChassisAlignToLine(int left, int right, kTiles tile)
+void ChassisAlignToLineStart(int left, int right, kTiles tile)
 {
-	bool hasPassedLeft = false, hasPassedRight = false;
-	bool hasHadLeft = false, hasHadRight = false;
-	int goodCount = 0;
-	while (goodCount < 20)
+	AlignLeft = left;
+	AlignRight = right;
+	AlignTile = tile;
+	AlignPassedLeft = AlignPassedRight = false;
+	AlignHadLeft = AlignHadRight = false;
+	AlignLast = millis();
+	AlignOnLine = 0;
+}
+
+/**
+ * @brief Runs through one iteration of the alignment started by ChassisAlignToLineStart(). Each side drives toward
+ *        the line and back over it until both IR sensors have been on it for CHASSIS_ALIGN_SETTLE milliseconds.
+ *
+ * @returns Returns true once the robot is aligned (and stopped)
+ */
+bool ChassisAlignToLineContinuous()
+{
+	if (ChassisHasIRLineRight(AlignTile) && !AlignHadRight)
 	{
-		if (ChassisHasIRLineRight(tile) && !hasHadRight)
-		{
-			hasPassedRight = !hasPassedRight;
-			hasHadRight = true;
-		}
-		else if (!ChassisHasIRLineRight(tile)) hasHadRight = false;
+		AlignPassedRight = !AlignPassedRight;
+		AlignHadRight = true;
+	}
+	else if (!ChassisHasIRLineRight(AlignTile)) AlignHadRight = false;
 
-		if (ChassisHasIRLineLeft(tile) && !hasHadLeft)
-		{
-			hasPassedLeft = !hasPassedLeft;
-			hasHadLeft = true;
-		}
-		else if (!ChassisHasIRLineLeft(tile)) hasHadLeft = false;
+	if (ChassisHasIRLineLeft(AlignTile) && !AlignHadLeft)
+	{
+		AlignPassedLeft = !AlignPassedLeft;
+		AlignHadLeft = true;
+	}
+	else if (!ChassisHasIRLineLeft(AlignTile)) AlignHadLeft = false;
+
+	if (ChassisHasIRLineLeft(AlignTile))
+		ChassisSetLeft(0, false);
+	else
+		ChassisSetLeft(AlignLeft * (AlignPassedLeft ? -1 : 1), false);
+
+	if (ChassisHasIRLineRight(AlignTile))
+		ChassisSetRight(0, false);
+	else
+		ChassisSetRight(AlignRight * (AlignPassedRight ? -1 : 1), false);
 
-		if (ChassisHasIRLineLeft(tile))
-			ChassisSetLeft(0, false);
-		else
-			ChassisSetLeft(left * (hasPassedLeft ? -1 : 1), false);
-		
-		if (ChassisHasIRLineRight(tile))
-			ChassisSetRight(0, false);
-		else
-			ChassisSetRight(right * (hasPassedRight ? -1 : 1), false);
+	unsigned long now = millis();
+	if (ChassisHasIRLineLeft(AlignTile) && ChassisHasIRLineRight(AlignTile)) AlignOnLine += now - AlignLast;
+	AlignLast = now;
 
-		if (ChassisHasIRLineLeft(tile) && ChassisHasIRLineRight(tile)) goodCount++;
+	if (AlignOnLine < CHASSIS_ALIGN_SETTLE)
+		return false;
+	ChassisSet(0, 0, false);
+	return true;
+}
 
+/**
+ * @brief Aligns robot to a kTile tile intially going provided speeds.
+ *
+ * @param left
+ *			The initial motor speed for the left side of the chassis
+ *
+ * @param right
+ *			The intial motor speed for the right side of the chassis
+ *
+ * @param tile
+ *			The tile that the line is detected on
+ */
+void ChassisAlignToLine(int left, int right, kTiles tile)
+{
+	ChassisAlignToLineStart(left, right, tile);
+	while (!ChassisAlignToLineContinuous())
 		delay(5);
+}
+
+/**
+ * @brief Starts watching the conditions of until for a move the caller has already started (with ChassisSet(),
+ *        ChassisSetMecanum(), ...). Call ChassisUntilContinuous() until it returns true.
+ *
+ * @param until
+ *			Conditions which end the move, must stay valid until it has ended
+ */
+void ChassisUntilStart(const ChassisUntil *until)
+{
+	ActiveUntil = until;
+	UntilStart = millis();
+	UntilLeft = ChassisGetIMELeft();
+	UntilRight = ChassisGetIMERight();
+	UntilHadLine = ChassisHasIRLineLeft(until->tile) || ChassisHasIRLineRight(until->tile);
+}
+
+/**
+ * @brief Checks the conditions of the move started by ChassisUntilStart() once, and stops the chassis if one holds
+ *
+ * @param stop
+ *			Set to the condition which ended the move, may be NULL
+ *
+ * @returns Returns true once the move has ended
+ */
+bool ChassisUntilContinuous(kChassisStop *stop)
+{
+	const ChassisUntil *until = ActiveUntil;
+	kChassisStop reason;
+	bool hasLine = ChassisHasIRLineLeft(until->tile) || ChassisHasIRLineRight(until->tile);
+	if (millis() - UntilStart >= until->timeout)
+		reason = ChassisStopTimeout;
+	// A degraded IME reads garbage, so only the other conditions and the timeout can end the move
+	else if (until->distance > 0 && !ChassisIMEsDegraded() && (abs(ChassisGetIMELeft() - UntilLeft) +
+		abs(ChassisGetIMERight() - UntilRight)) / 2 >= until->distance)
+		reason = ChassisStopDistance;
+	// Only the edge counts, so a move which starts on a line drives off it first
+	else if (until->line && hasLine && !UntilHadLine)
+		reason = ChassisStopLine;
+	else if (until->limit != 0 && digitalRead(until->limit) == LOW)
+		reason = ChassisStopLimit;
+	else
+	{
+		UntilHadLine = hasLine;
+		return false;
 	}
-	ChassisSet(0, 0, false);
+	ChassisSet(0, 0, true);
+	if (stop != NULL)
+		*stop = reason;
+	return true;
+}
+
+/**
+ * @brief Waits until one of the conditions of until holds, then stops the chassis
+ */
+static kChassisStop chassisWaitUntil(const ChassisUntil *until)
+{
+	kChassisStop stop;
+	ChassisUntilStart(until);
+	while (!ChassisUntilContinuous(&stop))
+		delay(5);
+	return stop;
+}
+
+/**
+ * @brief Drives the chassis like ChassisSet() until a condition holds, then stops it. Returns which condition
+ *        ended the move.
+ *
+ * @param left
+ *			[-127,127] Speed of the left side
+ *
+ * @param right
+ *			[-127,127] Speed of the right side
+ *
+ * @param until
+ *			Conditions which end the move
+ */
+kChassisStop ChassisDriveUntil(int left, int right, const ChassisUntil *until)
+{
+	ChassisSet(left, right, false);
+	return chassisWaitUntil(until);
+}
+
+/**
+ * @brief Drives the chassis like ChassisSetMecanum() until a condition holds, then stops it. Returns which condition
+ *        ended the move.
+ *
+ * @param heading
+ *			Direction in radians, see ChassisSetMecanum()
+ *
+ * @param speed
+ *			[-127,127] Speed of the chassis
+ *
+ * @param rotation
+ *			[-127,127] Rotation of the chassis
+ *
+ * @param until
+ *			Conditions which end the move
+ */
+kChassisStop ChassisMecanumUntil(double heading, int speed, int rotation, const ChassisUntil *until)
+{
+	ChassisSetMecanum(heading, speed, rotation, false);
+	return chassisWaitUntil(until);
 }
 
 /**
@@ -333,14 +591,16 @@ void ChassisAlignToLine(int left, int right, kTiles tile)
 */
 void ChassisInitialize()
 {
-	MotorConfigure(MOTOR_CHASSIS_FRONTLEFT, true, CHASSIS_SKEW_PROFILE);
-	MotorConfigure(MOTOR_CHASSIS_FRONTRIGHT, true, CHASSIS_SKEW_PROFILE);
-	MotorConfigure(MOTOR_CHASSIS_REARLEFT, false, CHASSIS_SKEW_PROFILE);
-	MotorConfigure(MOTOR_CHASSIS_REARRIGHT, false, CHASSIS_SKEW_PROFILE);
+	MotorConfigure(MOTOR_CHASSIS_FRONTLEFT, true, ChassisSkewRate);
+	MotorConfigure(MOTOR_CHASSIS_FRONTRIGHT, true, ChassisSkewRate);
+	MotorConfigure(MOTOR_CHASSIS_REARLEFT, false, ChassisSkewRate);
+	MotorConfigure(MOTOR_CHASSIS_REARRIGHT, false, ChassisSkewRate);
 
 	//										Execute			Get					    Kp    Ki     Kd   MaxI MinI Tol
 	leftController = PIDControllerCreate(&ChassisSetLeft, &ChassisGetIMELeft,	 0.20, 0.17, 0.001, 100, -100, 20);
 	rightController = PIDControllerCreate(&ChassisSetRight, &ChassisGetIMERight, 0.20, 0.17, 0.001, 100, -100, 20);
 
+	lcdformatCompile(&chassisIMEFormat, "cl:%04d r:%04d");
+
 	//gyro = gyroInit(ANA_GYROSCOPE, 196);
 }
\ No newline at end of file
@@ -0,0 +1,129 @@
+/**
+ * @file vulcan/LCDDisplays.c
+ * @brief Menus of Vulcan: autonomous selection and live tuning of the lift and chassis.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#include "main.h"
+#include "lcd/LCDFunctions.h"
+#include "lcd/lcdtree.h"
+
+#include "vulcan/AutonScript.h"
+#include "vulcan/Chassis.h"
+#include "vulcan/ghost.h"
+#include "vulcan/LCDDisplays.h"
+#include "vulcan/Lift.h"
+
+/**
+ * @brief The selected autonomous, an index of titles
+ */
+int AutonSelection = 0;
+
+/**
+ * @brief Keeps main_menu (run by autonomous()) in sync with AutonSelection
+ */
+static void autonSelected(LCDTreeItem *item)
+{
+	main_menu.execute = (unsigned char)AutonSelection;
+}
+
+static void liftTuned(LCDTreeItem *item)
+{
+	LiftApplyTuning();
+}
+
+static void chassisTuned(LCDTreeItem *item)
+{
+	ChassisApplyTuning();
+}
+
+static void ghostRecord(LCDTreeItem *item)
+{
+	lcdprint_d(Centered, 2, 1000, GhostRecordStart() ? "Recording" : "Busy");
+}
+
+static void ghostStop(LCDTreeItem *item)
+{
+	GhostRecordStop();
+}
+
+static void scriptReceive(LCDTreeItem *item)
+{
+	lcdprint_d(Centered, 2, 1000, AutonScriptReceive() ? "Listening" : "Already on");
+}
+
+static LCDTreeItem autonItems[] = {
+	{ .title = "Autonomous", .type = LCDTreeEnum, .value = &AutonSelection, .min = 0, .max = NUMTITLES - 1,
+		.options = (const char **)titles, .callback = &autonSelected },
+	{ .title = "Receive script", .type = LCDTreeAction, .callback = &scriptReceive },
+};
+
+// Gains are edited in thousandths, skew rates in hundredths of PWM per millisecond. Values are bound at runtime.
+static LCDTreeItem liftItems[] = {
+	{ .title = "Lift Kp", .type = LCDTreeDecimal, .min = 0, .max = 10000, .step = 10, .scale = 1000, .decimals = 3, .callback = &liftTuned },
+	{ .title = "Lift Ki", .type = LCDTreeDecimal, .min = 0, .max = 10000, .step = 10, .scale = 1000, .decimals = 3, .callback = &liftTuned },
+	{ .title = "Lift Kd", .type = LCDTreeDecimal, .min = 0, .max = 10000, .step = 10, .scale = 1000, .decimals = 3, .callback = &liftTuned },
+	{ .title = "Lift skew", .type = LCDTreeDecimal, .value = &LiftSkewRate, .min = 5, .max = 1000, .step = 5, .scale = 100, .decimals = 2, .callback = &liftTuned },
+	{ .title = "High post", .type = LCDTreeInt, .value = &LiftPresetHeights[LiftHighPost], .min = 0, .max = 150, .step = 1 },
+	{ .title = "Medium post", .type = LCDTreeInt, .value = &LiftPresetHeights[LiftMediumPost], .min = 0, .max = 150, .step = 1 },
+	{ .title = "Low post", .type = LCDTreeInt, .value = &LiftPresetHeights[LiftLowPost], .min = 0, .max = 150, .step = 1 },
+	{ .title = "Single cube", .type = LCDTreeInt, .value = &LiftPresetHeights[LiftSingleCube], .min = 0, .max = 150, .step = 1 },
+};
+
+static LCDTreeItem chassisItems[] = {
+	{ .title = "Chassis Kp", .type = LCDTreeDecimal, .min = 0, .max = 5000, .step = 5, .scale = 1000, .decimals = 3, .callback = &chassisTuned },
+	{ .title = "Chassis Ki", .type = LCDTreeDecimal, .min = 0, .max = 5000, .step = 5, .scale = 1000, .decimals = 3, .callback = &chassisTuned },
+	{ .title = "Chassis Kd", .type = LCDTreeDecimal, .min = 0, .max = 5000, .step = 1, .scale = 1000, .decimals = 3, .callback = &chassisTuned },
+	{ .title = "Chassis skew", .type = LCDTreeDecimal, .value = &ChassisSkewRate, .min = 5, .max = 1000, .step = 5, .scale = 100, .decimals = 2, .callback = &chassisTuned },
+};
+
+// Recording happens in the teleop loop, so start it while driving
+static LCDTreeItem ghostItems[] = {
+	{ .title = "Record ghost", .type = LCDTreeAction, .callback = &ghostRecord },
+	{ .title = "Stop ghost", .type = LCDTreeAction, .callback = &ghostStop },
+};
+
+static LCDTreeItem rootItems[] = {
+	{ .title = "Autonomous", .type = LCDTreeSubmenu, .children = autonItems, .numChildren = sizeof(autonItems) / sizeof(LCDTreeItem) },
+	{ .title = "Lift", .type = LCDTreeSubmenu, .children = liftItems, .numChildren = sizeof(liftItems) / sizeof(LCDTreeItem) },
+	{ .title = "Chassis", .type = LCDTreeSubmenu, .children = chassisItems, .numChildren = sizeof(chassisItems) / sizeof(LCDTreeItem) },
+	{ .title = "Ghost", .type = LCDTreeSubmenu, .children = ghostItems, .numChildren = sizeof(ghostItems) / sizeof(LCDTreeItem) },
+};
+
+static LCDTreeItem rootMenu = { .title = "Vulcan", .type = LCDTreeSubmenu, .children = rootItems, .numChildren = sizeof(rootItems) / sizeof(LCDTreeItem) };
+static LCDTreeItem autonMenu = { .title = "Autonomous", .type = LCDTreeSubmenu, .children = autonItems, .numChildren = sizeof(autonItems) / sizeof(LCDTreeItem) };
+
+/**
+ * @brief Binds the tuning items to the lift and chassis controllers and starts the menu task. Hold the center LCD
+ *        button to open the menu.
+ *
+ * @pre LiftInitialize() and ChassisInitialize() have been called
+ */
+void MenuInitialize()
+{
+	MasterSlavePIDController *lift = LiftGetController();
+	liftItems[0].value = &lift->master.Kp;
+	liftItems[1].value = &lift->master.Ki;
+	liftItems[2].value = &lift->master.Kd;
+
+	PIDController *chassis = ChassisGetController();
+	chassisItems[0].value = &chassis->Kp;
+	chassisItems[1].value = &chassis->Ki;
+	chassisItems[2].value = &chassis->Kd;
+
+	main_menu.execute = (unsigned char)AutonSelection;
+	lcdtreeInitialize(&rootMenu);
+}
+
+/**
+ * @brief Opens the autonomous selection menu. Returns immediately.
+ */
+void MenuOpenAutonSelect()
+{
+	lcdtreeOpen(&autonMenu);
+}
@@ -9,6 +9,7 @@
  * @endhtmlonly
  ********************************************************************************/
 
+#include <math.h>
 #include <string.h>
 
 #include "main.h"
@@ -16,6 +17,8 @@
 
 #include "lcd/LCDFunctions.h"
 #include "sml/SmartMotorLibrary.h"
+#include "sml/EncoderVelocity.h"
+#include "sml/IMEManager.h"
 #include "sml/MasterSlavePIDController.h"
 #include "sml/SingleThreadPIDController.h"
 
@@ -27,7 +30,17 @@
 #define LIFT_SKEW_RATE			1.75
 #define QUAD_ENC_MIN_THRESH		8
 
-static Encoder rightEncoder, leftEncoder;
+static EncoderVelocity *rightEncoder, *leftEncoder;
+
+/**
+ * @brief Skew rate of every lift motor, see LiftApplyTuning()
+ */
+double LiftSkewRate = LIFT_SKEW_RATE;
+
+/**
+ * @brief Heights of the lift presets, indexed by LiftPresets
+ */
+int LiftPresetHeights[LIFT_NUM_PRESETS] = { 85, 13, 20, 8 };
 // ---------------- LEFT  SIDE ---------------- //
 /**
  * @brief Sets the speed of the left side of the lift
@@ -72,7 +85,7 @@ int LiftGetCalibIMELeft()
 
 	if (digitalRead(DIG_LIFT_BOTLIM_LEFT) == LOW)
 	{
-		imeReset(I2C_MOTOR_LIFT_LEFT);
+		IMEManagerReset(I2C_MOTOR_LIFT_LEFT);
 		memset(prevValues, 0, sizeof(prevValues));
 		return 0;
 	}
@@ -89,7 +102,7 @@ int LiftGetCalibIMELeft()
 int LiftGetRawIMELeft()
 {
 	int val;
-	imeGet(I2C_MOTOR_LIFT_LEFT, &val);
+	IMEManagerGet(I2C_MOTOR_LIFT_LEFT, &val);
 	return val;
 }
 
@@ -99,9 +112,18 @@ int LiftGetRawIMELeft()
 int LiftGetQuadEncLeft()
 {
 	if (digitalRead(DIG_LIFT_BOTLIM_LEFT) == LOW)
-		encoderReset(leftEncoder);
+		EncoderVelocityReset(leftEncoder);
+
+	return EncoderVelocityGetCount(leftEncoder);
+}
 
-	return encoderGet(leftEncoder);
+/**
+ * @brief Returns the velocity of the left lift quadrature encoder in ticks per second (positive is up). The lift
+ *        controller uses it for velocity feedforward while following a trajectory.
+ */
+int LiftGetVelocityLeft()
+{
+	return EncoderVelocityGet(leftEncoder);
 }
 
 /**
@@ -185,7 +207,7 @@ int LiftGetCalibIMERight()
 
 	if (digitalRead(DIG_LIFT_BOTLIM_RIGHT) == LOW)
 	{
-		imeReset(I2C_MOTOR_LIFT_RIGHT);
+		IMEManagerReset(I2C_MOTOR_LIFT_RIGHT);
 		memset(prevValues, 0, sizeof(prevValues));
 		return 0;
 	}
@@ -202,7 +224,7 @@ int LiftGetCalibIMERight()
 int LiftGetRawIMERight()
 {
 	int val;
-	imeGet(I2C_MOTOR_LIFT_RIGHT, &val);
+	IMEManagerGet(I2C_MOTOR_LIFT_RIGHT, &val);
 	return -val;
 }
 
@@ -212,9 +234,18 @@ int LiftGetRawIMERight()
 int LiftGetQuadEncRight()
 {
 	if (digitalRead(DIG_LIFT_BOTLIM_RIGHT) == LOW)
-		encoderReset(rightEncoder);
+		EncoderVelocityReset(rightEncoder);
 
-	return -encoderGet(rightEncoder);
+	return -EncoderVelocityGetCount(rightEncoder);
+}
+
+/**
+ * @brief Returns the velocity of the right lift quadrature encoder in ticks per second (positive is up). The lift
+ *        controller uses it for velocity feedforward while following a trajectory.
+ */
+int LiftGetVelocityRight()
+{
+	return -EncoderVelocityGet(rightEncoder);
 }
 
 /**
@@ -291,6 +322,8 @@ bool LiftSetHeight(int value)
 	return false;
 }
 
+static LCDFormat liftEncoderFormat;
+
 /**
  * @brief Goes to intended height to completion
  *
@@ -310,12 +343,38 @@ void LiftGoToHeightCompletion(int value)
 		MasterSlavePIDSetGoal(&Controller, value);
 		while (!MasterSlavePIDOnTarget(&Controller))
 		{
-			lcdprintf(Centered, 2, "l:%04d r:%04d", LiftGetQuadEncLeft(), LiftGetQuadEncRight());
+			lcdprintc(Centered, 2, &liftEncoderFormat, LiftGetQuadEncLeft(), LiftGetQuadEncRight());
 			delay(100);
 		}
 	}
 }
 
+/**
+ * @brief Returns the lift's master/slave PID controller so its gains can be tuned. Change the master's gains and call
+ *        LiftApplyTuning().
+ */
+MasterSlavePIDController *LiftGetController()
+{
+	return &Controller;
+}
+
+/**
+ * @brief Applies tuned values: copies the master's gains to the slave and LiftSkewRate to every lift motor
+ */
+void LiftApplyTuning()
+{
+	Controller.slave.Kp = Controller.master.Kp;
+	Controller.slave.Ki = Controller.master.Ki;
+	Controller.slave.Kd = Controller.master.Kd;
+
+	MotorChangeSkew(MOTOR_LIFT_FRONTLEFT, LiftSkewRate);
+	MotorChangeSkew(MOTOR_LIFT_FRONTRIGHT, LiftSkewRate);
+	MotorChangeSkew(MOTOR_LIFT_MIDDLELEFT, LiftSkewRate);
+	MotorChangeSkew(MOTOR_LIFT_MIDDLERIGHT, LiftSkewRate);
+	MotorChangeSkew(MOTOR_LIFT_REARLEFT, LiftSkewRate);
+	MotorChangeSkew(MOTOR_LIFT_REARRIGHT, LiftSkewRate);
+}
+
 /**
  * @brief Returns true if the PID controller is on target
  */
@@ -325,6 +384,84 @@ bool LiftGoToHeightContinuous(int value)
 	return MasterSlavePIDOnTarget(&Controller);
 }
 
+/**
+ * @brief Computes a trapezoidal move of the lift: up to LIFT_PROFILE_VELOCITY at LIFT_PROFILE_ACCELERATION, then
+ *        slowing down at the same rate to stop on target. Short moves never reach full speed. Meant for
+ *        initialize(), as it uses floating point.
+ *
+ * @param trajectory
+ *			The trajectory to fill in
+ *
+ * @param start
+ *			Height the move starts from
+ *
+ * @param target
+ *			Height the move ends at
+ */
+void LiftTrajectoryCompute(LiftTrajectory *trajectory, int start, int target)
+{
+	double distance = abs(target - start);
+	double velocity = LIFT_PROFILE_VELOCITY, acceleration = LIFT_PROFILE_ACCELERATION;
+	if (distance < velocity * velocity / acceleration)
+		velocity = sqrt(distance * acceleration); // Triangular: slow down as soon as full speed would overshoot
+	double rampTime = velocity / acceleration;
+	double rampDistance = velocity * rampTime / 2;
+	double cruiseTime = (distance - 2 * rampDistance) / velocity;
+	double duration = 2 * rampTime + cruiseTime;
+
+	int numPoints = (int)ceil(duration * 1000 / MASTER_SLAVE_PID_DELTAT);
+	if (numPoints < 1)
+		numPoints = 1;
+	if (numPoints > LIFT_TRAJECTORY_MAX_POINTS)
+		numPoints = LIFT_TRAJECTORY_MAX_POINTS; // The last point is the target, so the controller finishes the move
+	for (int i = 0; i < numPoints; i++)
+	{
+		double t = (i + 1) * MASTER_SLAVE_PID_DELTAT / 1000.0, travelled, speed;
+		if (t < rampTime)
+		{
+			travelled = acceleration * t * t / 2;
+			speed = acceleration * t;
+		}
+		else if (t < rampTime + cruiseTime)
+		{
+			travelled = rampDistance + velocity * (t - rampTime);
+			speed = velocity;
+		}
+		else
+		{
+			double slowing = fmin(t, duration) - rampTime - cruiseTime;
+			travelled = distance - rampDistance + velocity * slowing - acceleration * slowing * slowing / 2;
+			speed = velocity - acceleration * slowing;
+		}
+		trajectory->points[i] = start + (int)lround(target > start ? travelled : -travelled);
+		trajectory->velocities[i] = (short)lround(target > start ? speed : -speed);
+	}
+	trajectory->points[numPoints - 1] = target;
+	trajectory->velocities[numPoints - 1] = 0;
+	trajectory->numPoints = numPoints;
+	trajectory->target = target;
+}
+
+/**
+ * @brief Starts the lift controller along a trajectory from LiftTrajectoryCompute(). The planned speed is fed forward
+ *        (LIFT_FEEDFORWARD_KV), corrected by the measured speed of each side. The lift holds the target once the
+ *        trajectory ends. LiftSet() and the height functions stop it.
+ */
+void LiftFollowTrajectory(const LiftTrajectory *trajectory)
+{
+	MasterSlavePIDFollowProfile(&Controller, trajectory->points, trajectory->velocities, trajectory->numPoints);
+}
+
+/**
+ * @brief Starts the lift along a trajectory unless it is already following it or holding its target. Returns true
+ *        once the trajectory has ended and the PID controller is on target.
+ */
+bool LiftFollowTrajectoryContinuous(const LiftTrajectory *trajectory)
+{
+	return MasterSlavePIDFollowProfileContinuous(&Controller, trajectory->points, trajectory->velocities,
+		trajectory->numPoints);
+}
+
 /**
  * @brief Returns the difference between the IMES (right - left)
  *		  Used in the equailizer controller in the MasterSlavePIDController for the lift
@@ -380,15 +517,15 @@ static int liftComputePotDiff()
  */
 void LiftInitialize()
 {
-	MotorConfigure(MOTOR_LIFT_FRONTLEFT,	true, LIFT_SKEW_RATE);
-	MotorConfigure(MOTOR_LIFT_FRONTRIGHT,	false, LIFT_SKEW_RATE);
-	MotorConfigure(MOTOR_LIFT_MIDDLELEFT,	false, LIFT_SKEW_RATE);
-	MotorConfigure(MOTOR_LIFT_MIDDLERIGHT,	false, LIFT_SKEW_RATE);
-	MotorConfigure(MOTOR_LIFT_REARLEFT,		true, LIFT_SKEW_RATE);
-	MotorConfigure(MOTOR_LIFT_REARRIGHT,	false, LIFT_SKEW_RATE);
+	MotorConfigure(MOTOR_LIFT_FRONTLEFT,	true, LiftSkewRate);
+	MotorConfigure(MOTOR_LIFT_FRONTRIGHT,	false, LiftSkewRate);
+	MotorConfigure(MOTOR_LIFT_MIDDLELEFT,	false, LiftSkewRate);
+	MotorConfigure(MOTOR_LIFT_MIDDLERIGHT,	false, LiftSkewRate);
+	MotorConfigure(MOTOR_LIFT_REARLEFT,		true, LiftSkewRate);
+	MotorConfigure(MOTOR_LIFT_REARRIGHT,	false, LiftSkewRate);
 		
-	leftEncoder = encoderInit(DIG_LIFT_ENC_LEFT_TOP, DIG_LIFT_ENC_LEFT_BOT, false);
-	rightEncoder = encoderInit(DIG_LIFT_ENC_RIGHT_TOP, DIG_LIFT_ENC_RIGHT_BOT, true);
+	leftEncoder = EncoderVelocityInit(DIG_LIFT_ENC_LEFT_TOP, DIG_LIFT_ENC_LEFT_BOT, false);
+	rightEncoder = EncoderVelocityInit(DIG_LIFT_ENC_RIGHT_TOP, DIG_LIFT_ENC_RIGHT_BOT, true);
 	
 	//                                           Execute           Call			    Kp    Ki   Kd   MaI  MiI  Tol
 	PIDController master = PIDControllerCreate(&LiftSetLeft, &LiftGetQuadEncLeft,  3.15, 0.18, 0.15, 125, -75, 5);
@@ -396,6 +533,10 @@ void LiftInitialize()
 	PIDController equalizer = PIDControllerCreate(NULL, &liftComputeQuadEncDiff,   0.85, 0.37, 0.01, 90, -75, 3);
 
 	Controller = CreateMasterSlavePIDController(master, slave, equalizer, 127, -100, false);
+	MasterSlavePIDSetFeedforward(&Controller, LIFT_FEEDFORWARD_KV, LIFT_FEEDFORWARD_KV_ERROR, &LiftGetVelocityLeft,
+		&LiftGetVelocityRight);
 
 	LiftControllerTask = InitializeMasterSlaveController(&Controller, 0);
+
+	lcdformatCompile(&liftEncoderFormat, "l:%04d r:%04d");
 }
\ No newline at end of file
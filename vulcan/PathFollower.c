@@ -0,0 +1,242 @@
+/**
+ * @file vulcan/PathFollower.c
+ * @author Elliot Berman
+ * @brief Follows a path of waypoints with the mecanum chassis in one continuous motion (pure pursuit).
+ *
+ * @details Every iteration the pose of the chassis is estimated from the chassis IMEs, then the chassis is steered
+ *          with ChassisSetMecanum() toward the point of the path one lookahead distance ahead, while rotating
+ *          toward the heading interpolated between the waypoints around that point. Speed ramps down over the last
+ *          PATH_SLOWDOWN ticks. <br>
+ *          There is one IME per side and no gyro, so forward travel is measured but strafe and rotation both show up
+ *          as a difference between the sides. The difference is split between them in the proportion they were
+ *          commanded, scaled by how fast the wheels actually turned.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#include <math.h>
+
+#include "main.h"
+#include "sml/CommandScheduler.h"
+
+#include "vulcan/Chassis.h"
+#include "vulcan/PathFollower.h"
+
+static const Path *ActivePath;
+static unsigned char Segment;
+static Pose CurrentPose;
+static int LastLeft, LastRight;
+/**
+ * @brief The last command, as forward, strafe, and rotation wheel speeds
+ */
+static double CommandForward, CommandStrafe, CommandRotation;
+
+/**
+ * @brief Wraps an angle to [-PI,PI]
+ */
+static double pathWrap(double angle)
+{
+	while (angle > M_PI) angle -= 2 * M_PI;
+	while (angle < -M_PI) angle += 2 * M_PI;
+	return angle;
+}
+
+/**
+ * @brief Advances the pose by the IME counts since the last update
+ */
+static void pathUpdatePose()
+{
+	int left = ChassisGetIMELeft(), right = ChassisGetIMERight();
+	double dLeft = left - LastLeft, dRight = right - LastRight;
+	LastLeft = left;
+	LastRight = right;
+
+	// What the two measured wheels were told to do, see ChassisSetHolonomic()
+	double leftCommand = CommandForward + PATH_IME_STRAFE_SIGN * CommandStrafe - CommandRotation;
+	double rightCommand = CommandForward - PATH_IME_STRAFE_SIGN * CommandStrafe + CommandRotation;
+	double commanded = fabs(leftCommand) + fabs(rightCommand);
+	double scale = commanded > 0 ? (fabs(dLeft) + fabs(dRight)) / commanded : 0;
+
+	double forward = (dLeft + dRight) / 2;
+	double strafe = scale * CommandStrafe;
+	double rotation = (dRight - dLeft) / 2 + PATH_IME_STRAFE_SIGN * strafe;
+	double dHeading = rotation / PATH_TICKS_PER_RADIAN;
+
+	double heading = CurrentPose.heading + dHeading / 2;
+	CurrentPose.x += forward * cos(heading) - strafe * sin(heading);
+	CurrentPose.y += forward * sin(heading) + strafe * cos(heading);
+	CurrentPose.heading = pathWrap(CurrentPose.heading + dHeading);
+}
+
+/**
+ * @brief Finds the point to steer toward on the current segment
+ *
+ * @param t
+ *			Set to how far along the segment the point is, [0,1]
+ *
+ * @returns Returns false if the chassis is farther than the lookahead from the segment, in which case t is that of
+ *          the closest point of the segment
+ */
+static bool pathLookahead(double *t)
+{
+	const Waypoint *a = &ActivePath->points[Segment], *b = &ActivePath->points[Segment + 1];
+	double dx = b->x - a->x, dy = b->y - a->y;
+	double fx = a->x - CurrentPose.x, fy = a->y - CurrentPose.y;
+	double length2 = dx * dx + dy * dy;
+	if (length2 == 0)
+	{
+		*t = 1;
+		return true;
+	}
+
+	// Farthest intersection of the lookahead circle with the segment's line
+	double lookahead = ActivePath->lookahead;
+	double half = fx * dx + fy * dy, c = fx * fx + fy * fy - lookahead * lookahead;
+	double discriminant = half * half - length2 * c;
+	double closest = -half / length2;
+	closest = closest < 0 ? 0 : (closest > 1 ? 1 : closest);
+	if (discriminant < 0)
+	{
+		*t = closest;
+		return false;
+	}
+	double far = (-half + sqrt(discriminant)) / length2;
+	*t = far < closest ? closest : (far > 1 ? 1 : far);
+	return true;
+}
+
+/**
+ * @brief Starts following a path from the current position of the chassis, which becomes { 0, 0, 0 }. Resets the
+ *        chassis IMEs.
+ *
+ * @param path
+ *			The path, which must outlive the follow
+ */
+void PathStart(const Path *path)
+{
+	ChassisResetIMEs();
+	ActivePath = path;
+	Segment = 0;
+	CurrentPose.x = CurrentPose.y = CurrentPose.heading = 0;
+	LastLeft = ChassisGetIMELeft();
+	LastRight = ChassisGetIMERight();
+	CommandForward = CommandStrafe = CommandRotation = 0;
+}
+
+/**
+ * @brief Runs through one iteration of the path follower started by PathStart()
+ *
+ * @returns Returns true once the chassis is at the end of the path (and stopped). If the IMEs are degraded, the
+ *          chassis is stopped and true is returned so that autonomous moves on instead of driving on stale counts.
+ */
+bool PathFollowContinuous()
+{
+	if (ActivePath == NULL || ActivePath->numPoints < 2 || ChassisIMEsDegraded())
+	{
+		ChassisSet(0, 0, true);
+		return true;
+	}
+	pathUpdatePose();
+
+	const Waypoint *points = ActivePath->points;
+	int last = ActivePath->numPoints - 1;
+	// Move on to the next segment once its start is within the lookahead
+	while (Segment + 1 < last && hypot(points[Segment + 1].x - CurrentPose.x,
+		points[Segment + 1].y - CurrentPose.y) < ActivePath->lookahead)
+		Segment++;
+
+	double t;
+	pathLookahead(&t);
+	const Waypoint *a = &points[Segment], *b = &points[Segment + 1];
+	double targetX = a->x + t * (b->x - a->x), targetY = a->y + t * (b->y - a->y);
+	double targetHeading = a->heading + t * (b->heading - a->heading);
+
+	double dx = targetX - CurrentPose.x, dy = targetY - CurrentPose.y;
+	double headingError = pathWrap(targetHeading - CurrentPose.heading);
+	double toEnd = hypot(points[last].x - CurrentPose.x, points[last].y - CurrentPose.y);
+	if (Segment + 1 == last && toEnd < PATH_TOLERANCE &&
+		fabs(pathWrap(points[last].heading - CurrentPose.heading)) < PATH_HEADING_TOLERANCE)
+	{
+		ChassisSet(0, 0, true);
+		CommandForward = CommandStrafe = CommandRotation = 0;
+		return true;
+	}
+
+	// Distance left along the path
+	double remaining = hypot(dx, dy) + (1 - t) * hypot(b->x - a->x, b->y - a->y);
+	for (int i = Segment + 1; i < last; i++)
+		remaining += hypot(points[i + 1].x - points[i].x, points[i + 1].y - points[i].y);
+	int speed = ActivePath->speed;
+	if (remaining < PATH_SLOWDOWN)
+		speed = (int)(speed * remaining / PATH_SLOWDOWN);
+	if (speed < PATH_MIN_SPEED && toEnd >= PATH_TOLERANCE)
+		speed = PATH_MIN_SPEED;
+	else if (toEnd < PATH_TOLERANCE)
+		speed = 0; // Only the heading is left
+
+	// Positive rotation speeds up the right side, turning counterclockwise
+	int rotation = (int)(PATH_HEADING_KP * headingError);
+	rotation = rotation > 127 ? 127 : (rotation < -127 ? -127 : rotation);
+
+	// Direction to the target relative to the chassis
+	double direction = atan2(dy, dx) - CurrentPose.heading;
+	ChassisSetMecanum(direction, speed, rotation, false);
+	CommandForward = speed * cos(direction) * M_SQRT1_2;
+	CommandStrafe = speed * sin(direction) * M_SQRT1_2;
+	CommandRotation = rotation;
+	return false;
+}
+
+/**
+ * @brief Follows a path to its end
+ *
+ * @param path
+ *			The path
+ */
+void PathFollowCompletion(const Path *path)
+{
+	PathStart(path);
+	while (!PathFollowContinuous())
+		delay(10);
+}
+
+/**
+ * @brief Returns the estimated pose of the chassis since PathStart()
+ */
+Pose PathGetPose()
+{
+	return CurrentPose;
+}
+
+static void pathFollowInitialize(Command *command)
+{
+	PathStart(command->data);
+}
+
+static bool pathFollowExecute(Command *command)
+{
+	return PathFollowContinuous();
+}
+
+static void pathFollowEnd(Command *command, bool interrupted)
+{
+	if (interrupted)
+		ChassisSet(0, 0, false);
+}
+
+/**
+ * @brief Returns a command which follows a path, like PathFollowCompletion()
+ *
+ * @param path
+ *			The path, which must outlive the command
+ */
+Command PathCommandFollow(const Path *path)
+{
+	Command command = { .type = CommandBasic, .Initialize = &pathFollowInitialize, .Execute = &pathFollowExecute,
+		.End = &pathFollowEnd, .data = path, .name = "path" };
+	return command;
+}
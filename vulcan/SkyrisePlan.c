@@ -0,0 +1,55 @@
+/**
+ * @file vulcan/SkyrisePlan.c
+ * @author Elliot Berman
+ * @brief The skyrise stacking plan shared by teleop (JoshControl()) and autonomous (BuildSkyrise()).
+ *
+ * @details Every level of the skyrise has one entry in SkyrisePlan. SkyrisePlanInitialize() turns the plan into lift
+ *          trajectories once, during initialize(), so stacking only hands a precomputed trajectory to the lift
+ *          controller: <br>
+ *          SkyriseCarryTrajectories[n] lifts a section grabbed with the lift down to level n (never lower than
+ *          SKYRISE_GRAB_HEIGHT), which is what teleop does when the claw closes. <br>
+ *          SkyriseStackTrajectories[n] moves a section held at SKYRISE_GRAB_HEIGHT to level n, which is what
+ *          autonomous does while backing up to the skyrise.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#include "main.h"
+
+#include "vulcan/Lift.h"
+#include "vulcan/SkyrisePlan.h"
+
+/**
+ * @brief The stacking plan, indexed by the number of sections already built
+ */
+const SkyriseLevel SkyrisePlan[SKYRISE_LEVELS] = {
+	//	height	approach	release
+	{	0,		-127,		0	},
+	{	19,		-127,		5	},
+	{	33,		-127,		0	},
+	{	48,		-127,		0	},
+	{	67,		-127,		0	},
+	{	83,		-127,		0	},
+	{	150,	-127,		0	},
+};
+
+LiftTrajectory SkyriseCarryTrajectories[SKYRISE_LEVELS];
+LiftTrajectory SkyriseStackTrajectories[SKYRISE_LEVELS];
+
+/**
+ * @brief Computes the carry and stack trajectories of every level of SkyrisePlan
+ */
+void SkyrisePlanInitialize()
+{
+	for (int level = 0; level < SKYRISE_LEVELS; level++)
+	{
+		int height = SkyrisePlan[level].height;
+		LiftTrajectoryCompute(&SkyriseCarryTrajectories[level], 0,
+			height > SKYRISE_GRAB_HEIGHT ? height : SKYRISE_GRAB_HEIGHT);
+		LiftTrajectoryCompute(&SkyriseStackTrajectories[level], SKYRISE_GRAB_HEIGHT, height);
+	}
+}
@@ -12,16 +12,36 @@
 #include "lcd/LCDFunctions.h"
 #include <math.h>
 
+#include "vulcan/AutonCommands.h"
+#include "vulcan/AutonScript.h"
 #include "vulcan/AutonomousHelper.h"
 #include "vulcan/Chassis.h"
+#include "vulcan/ghost.h"
 #include "vulcan/LCDDisplays.h"
 #include "vulcan/Lift.h"
+#include "vulcan/PathFollower.h"
 #include "vulcan/ScoringMechanism.h"
+#include "vulcan/SkyrisePlan.h"
+
+// Last, so it can profile the calls below without changing the declarations above
+#define AUTON_PROFILER_WRAP
+#include "vulcan/AutonProfiler.h"
 
 #define GREY_WHITE_LINE_THRESH	600
 #define BLUE_WHITE_LINE_THRESH	450
 #define RED_WHITE_LINE_THRESH	300
 
+// Moves of BuildSkyrise() in chassis IME ticks, each ended early by its timeout (milliseconds) if it stalls
+#define BUILD_BACKUP_TICKS			820 // Off of the red tile, short of the grey line (or stopped on it)
+#define BUILD_BACKUP_TIMEOUT		1200
+#define BUILD_STRAFE_TICKS_FIRST	65 // Right, from the line to over the base
+#define BUILD_STRAFE_TICKS			80
+#define BUILD_STRAFE_TIMEOUT		450
+#define BUILD_NUDGE_TICKS			20
+#define BUILD_NUDGE_TIMEOUT			60
+#define BUILD_UNSTRAFE_TICKS		12 // Left, back off of the skyrise
+#define BUILD_UNSTRAFE_TIMEOUT		200
+
 int skyriseBuilt = 0;
 
 /**
@@ -36,113 +56,62 @@ void DeployScoringMech()
 }
 
 /**
-* @brief Builds the next skyrise from the red tile
+* @brief Builds the next skyrise from the red tile. The lift moves while the chassis backs up and while it returns.
 */
 void BuildSkyrise()
 {
-	// Drive forward a little to ensure touching the skyrise
-	LiftGoToHeightContinuous(4);
-	ChassisSet(127, 127, false);
-	delay(100);
-	ChassisSet(0, 0, true);
-	delay(80);
-    
-    //Reset the IMEs
-	ChassisResetIMEs();
-    //extend claw
-	ScoringMechClawSet(true);
-    
-	// Go up to avoid skyrise base
-	LiftGoToHeightCompletion(15);
-	delay(25);
-    
     /**
-     * @note Go to specified height at specified speed to build the next
-     * Skyrise section. skyriseBuilt is an extern variable.
+     * @note Go to the height of the next section in the stacking plan at its
+     * approach speed. skyriseBuilt is an extern variable.
      */
-	int height = 0;
-	int speed = -127;
-	switch (skyriseBuilt)
-	{
-		case 0:
-			height = 0;
-			speed = -127;
-			break;
-		case 1:
-			height = 19;
-			speed = -127;
-			break;
-		case 2:
-			height = 33;
-			speed = -127;
-			break;
-	}
-	ChassisSet(speed, speed, false);
-	delay(100);
-    
-	long start = millis();
-	while (!LiftGoToHeightContinuous(height))
-	{
-		// Back up for at least 700 milliseconds to get off of red tile
-		if (millis() - start > 800)
-			ChassisSet(0, 0, false);
-		delay(10);
-	}
-	if (millis() - start < 800)
-        delay(800 - (millis() - start)); // Finish up remaining 600 milliseconds if necessary
-    
-	ChassisSet(0, 0, false);
-	delay(100);
-	ChassisAlignToLine(-30, -30, Grey); // Align self to line to ready for drop
-	delay(25);
-	ChassisSetMecanum(-M_PI_2, 127, 1, false);
-	//delay(150);
-    
-	if(skyriseBuilt == 0)
-       delay(250);
-	else if (skyriseBuilt <= 1)
-        delay(285);
-	else
-        delay(280);
-    
-	ChassisSet(0, 0, true);
-	if (skyriseBuilt == 0)
-	{
-		ChassisSet(-127, -127, false);
-		delay(40);
-		ChassisSet(0, 0, true);
-	}
-	if (skyriseBuilt > 1) {
-        // Once we build one skyrise, need to go forward a little to align correctly
-		ChassisSet(127, 127, false);
-		delay(40);
-		ChassisSet(0, 0, true);
-	}
-	
-	delay(550); // Wait for robot to settle
-	ScoringMechClawSet(false);
-	if (skyriseBuilt == 1)
-		LiftGoToHeightContinuous(5);
-	delay(300); // Wait for skyrise to drop far enough for robot to begin driving forward
-	if (skyriseBuilt == 1)
-		LiftGoToHeightContinuous(15);
-	if (skyriseBuilt <= 1)
-	{
-		ChassisSet(-127, -127, false);
-		delay(50);
-		ChassisSet(0, 0, false);
-	}
-	ChassisSetMecanum(M_PI_2, 127, 0, false);
-	if(skyriseBuilt == 0) delay(120);
-	else delay(80);
-	ChassisSet(0, 0, true);
-	delay(50);
-	//delay(1000);
-	ChassisResetIMEs();
-	ChassisSet(127, 127, false);
-	delay(250);
-	LiftGoToHeightContinuous(0);
-	ChassisGoToGoalCompletion(1050, 1050); // return to base tile
+	int index = skyriseBuilt < SKYRISE_LEVELS ? skyriseBuilt : SKYRISE_LEVELS - 1;
+	const SkyriseLevel *level = &SkyrisePlan[index];
+	ChassisUntil push = { .timeout = 100 };
+	ChassisUntil backup = { .distance = BUILD_BACKUP_TICKS, .line = true, .tile = Grey,
+		.timeout = BUILD_BACKUP_TIMEOUT };
+	ChassisUntil strafe = { .distance = skyriseBuilt == 0 ? BUILD_STRAFE_TICKS_FIRST : BUILD_STRAFE_TICKS,
+		.tile = Grey, .timeout = BUILD_STRAFE_TIMEOUT };
+	ChassisUntil nudge = { .distance = BUILD_NUDGE_TICKS, .tile = Grey, .timeout = BUILD_NUDGE_TIMEOUT };
+	ChassisUntil unstrafe = { .distance = BUILD_UNSTRAFE_TICKS, .tile = Grey, .timeout = BUILD_UNSTRAFE_TIMEOUT };
+
+	// Drive forward a little to ensure touching the skyrise while the lift comes down on it
+	Command forward = ChassisCommandDriveUntil(127, 127, &push), pushSettle = CommandWait(80);
+	Command pushing = COMMAND_GROUP(CommandSequential, &forward, &pushSettle);
+	Command low = LiftCommandToHeight(4);
+	Command touch = COMMAND_GROUP(CommandParallel, &pushing, &low);
+
+	// Extend the claw and go up to avoid the skyrise base
+	Command reset = ChassisCommandResetIMEs(), claw = ScoringMechCommandClaw(true);
+	Command grab = LiftCommandToHeight(SKYRISE_GRAB_HEIGHT), grabSettle = CommandWait(25);
+
+	// Back up off of the red tile while the lift rises, stopping short of the line or on it
+	Command back = ChassisCommandDriveUntil(level->approach, level->approach, &backup);
+	Command stack = LiftCommandFollowTrajectory(&SkyriseStackTrajectories[index]);
+	Command carry = COMMAND_GROUP(CommandParallel, &back, &stack);
+
+	Command align = ChassisCommandAlignToLine(-30, -30, Grey), alignSettle = CommandWait(25); // Ready for drop
+	Command over = ChassisCommandMecanumUntil(-M_PI_2, 127, 1, &strafe);
+	// Once we build one skyrise, need to go forward a little to align correctly
+	Command nudgeIn = skyriseBuilt == 0 ? ChassisCommandDriveUntil(-127, -127, &nudge) :
+		(skyriseBuilt > 1 ? ChassisCommandDriveUntil(127, 127, &nudge) : CommandWait(0));
+
+	Command settle = CommandWait(550); // Wait for robot to settle
+	Command release = ScoringMechCommandClaw(false);
+	Command releaseLift = level->release != 0 ? LiftCommandSetHeight(level->release) : CommandWait(0);
+	Command drop = CommandWait(300); // Wait for skyrise to drop far enough for robot to begin driving forward
+	Command releaseRaise = level->release != 0 ? LiftCommandSetHeight(SKYRISE_GRAB_HEIGHT) : CommandWait(0);
+	Command nudgeOut = skyriseBuilt <= 1 ? ChassisCommandDriveUntil(-127, -127, &nudge) : CommandWait(0);
+	Command off = ChassisCommandMecanumUntil(M_PI_2, 127, 0, &unstrafe), offSettle = CommandWait(50);
+
+	// Return to the base tile while the lift comes down
+	Command resetReturn = ChassisCommandResetIMEs();
+	Command down = LiftCommandToHeight(0), toBase = ChassisCommandToGoal(1050, 1050);
+	Command home = COMMAND_GROUP(CommandParallel, &down, &toBase);
+
+	Command routine = COMMAND_GROUP(CommandSequential, &touch, &reset, &claw, &grab, &grabSettle, &carry, &align,
+		&alignSettle, &over, &nudgeIn, &settle, &release, &releaseLift, &drop, &releaseRaise, &nudgeOut, &off,
+		&offSettle, &resetReturn, &home);
+	CommandRun(&routine);
 	ChassisSet(0, 0, true);
 	delay(50);
 	skyriseBuilt++;
@@ -156,15 +125,41 @@ void autonomous()
 	lcdprint(Centered, 2, "Running auton");
 #ifdef AUTO_DEBUG
 	long start = millis();
+	ProfilerReset();
 #endif
 	skyriseBuilt = 0;
 	ChassisResetIMEs();
 	lcdmenuExecute(&main_menu);
 #ifdef AUTO_DEBUG
-	lcdprint_df(Centered, 2, 2000, "Finished %.2f", (millis() - start)/1000.0);
+	lcdprint_df(Centered, 2, 2000, "Finished %.2q", (int)(millis() - start), 1000);
+	ProfilerDump(stdout);
+	ProfilerSave();
 #endif
 }
 
+/**
+ * @brief Plays back the ghost driver recorded from the LCD menu (Ghost > Record) through the teleop code
+ */
+void RunGhost()
+{
+	if (GhostPlaybackStart())
+		operatorControl();
+	else
+		lcdprint_d(Centered, 2, 1000, "No ghost");
+	ChassisSet(0, 0, true);
+	LiftSet(0, true);
+}
+
+/**
+ * @brief Runs the script received from the LCD menu (Autonomous > Receive script), see AutonScript.c
+ */
+void RunScript()
+{
+	AutonScriptRun();
+	ChassisSet(0, 0, true);
+	LiftSet(0, true);
+}
+
 /**
  * @brief Runs "no autonomous" autonomous for use when requested by teams or autonomous
  *        should not function. Will deploy scoring mechanism anyway.
@@ -175,33 +170,34 @@ void RunNoAutonomous()
 }
 
 /**
- * @brief Scores two Skyrise pieces from the blue starting tile next to the low post
+ * @brief From the skyrise to the low post: the old 750 millisecond strafe right and the 650/-550 tick turn
+ */
+static const Waypoint BlueSkyToPostPoints[] = { { 0, 0, 0 }, { 0, -900, -1.6 } };
+static const Path BlueSkyToPost = { BlueSkyToPostPoints, 2, 127, 300 };
+
+/**
+ * @brief Scores two Skyrise pieces from the blue starting tile next to the low post. The lift moves while the chassis
+ *        drives instead of before it.
  */
 void RunBlueSky()
 {
-	LiftGoToHeightCompletion(15);
-	ChassisGoToGoalCompletion(1800, 1800);
-	LiftGoToHeightCompletion(0);
-	delay(300);
-	LiftGoToHeightCompletion(90);
-	ChassisResetIMEs();
-	ChassisSetMecanum(-M_PI_2, 127, -2, false);
-	delay(750);
-	ChassisSet(0, 0, false);
-	delay(50);
-	ChassisResetIMEs();
-	ChassisGoToGoalCompletion(650, -550);
-	ChassisSet(127, 127, false);
-	delay(650);
-	ChassisSet(0, 0, false);
-	LiftGoToHeightCompletion(75);
-	ScoringMechNeedleSet(false); //drop 2 cubes
-	delay(1200);
-	LiftGoToHeightCompletion(90);
-	ChassisSet(-127, -127, false);
-	delay(800);
-	ChassisSet(0, 0, false);
-	LiftGoToHeightCompletion(0);
+	// Clear the skyrise base on the way to the skyrise
+	Command lift15 = LiftCommandToHeight(15), drive = ChassisCommandToGoal(1800, 1800);
+	Command approach = COMMAND_GROUP(CommandParallel, &lift15, &drive);
+	Command grab = LiftCommandToHeight(0), settle = CommandWait(300);
+
+	// Raise the skyrise while strafing right and turning to the post in one motion
+	Command lift90 = LiftCommandToHeight(90), toPost = PathCommandFollow(&BlueSkyToPost);
+	Command carry = COMMAND_GROUP(CommandParallel, &lift90, &toPost);
+
+	// Score and back off
+	Command forward = ChassisCommandSet(127, 127, 650);
+	Command lower = LiftCommandToHeight(75), drop = ScoringMechCommandNeedle(false), dropWait = CommandWait(1200); //drop 2 cubes
+	Command raise = LiftCommandToHeight(90), back = ChassisCommandSet(-127, -127, 800), down = LiftCommandToHeight(0);
+
+	Command routine = COMMAND_GROUP(CommandSequential, &approach, &grab, &settle, &carry, &forward, &lower, &drop,
+		&dropWait, &raise, &back, &down);
+	CommandRun(&routine);
 }
 
 /**
@@ -3,12 +3,15 @@
  * @author Elliot Berman
  *
  * @details The Buttons API enables press-once to trigger control, allowing button pressed to be made which act like taps.
- * The API works by holding a boolean "wasPressed" for each button and when buttonIsNewPress() is called, 
- * the method compares whether the press is a new press that has not previously been detected. <br>
+ * buttonsSample() reads all 24 joystick buttons and the 3 LCD buttons once per control loop tick into a bit mask (bit n
+ * is the button with value n in the buttons enumeration). Buttons that were pressed or released since the previous
+ * sample are found by XORing it with the new one, so every query after that is a mask test. <br>
  * <br>
  * This is useful in applications where the operator needs to press a button to change a state, but does not want 
  * the state to to change the state every time the button is checked. For example, toggling a solenoid on/off with
  * a single button. <br>
+ * Code can poll the edges with buttonIsNewPress() and buttonIsNewRelease(), or subscribe a callback with
+ * buttonSubscribe() which buttonsSample() calls when the edge happens. <br>
  * 
  * @htmlonly
  * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
@@ -21,23 +24,104 @@
 #include "vulcan/CortexDefinitions.h"
 #include "vulcan/buttons.h"
 
+#define BUTTONS_MAX_SUBSCRIBERS		8
+#define BUTTONS_PER_JOYSTICK		12
+
+/**
+ * @brief Button group and location on the joystick of the first 12 buttons, in enumeration order
+ */
+static const unsigned char ButtonGroup[BUTTONS_PER_JOYSTICK] = { 5, 5, 6, 6, 7, 7, 7, 7, 8, 8, 8, 8 };
+static const unsigned char ButtonLocation[BUTTONS_PER_JOYSTICK] = { JOY_DOWN, JOY_UP, JOY_DOWN, JOY_UP, JOY_UP,
+	JOY_LEFT, JOY_RIGHT, JOY_DOWN, JOY_UP, JOY_LEFT, JOY_RIGHT, JOY_DOWN };
+
+/**
+ * @brief A callback run by buttonsSample() on an edge of a button
+ */
+typedef struct
+{
+	buttons button;
+	ButtonEdge edge;
+	void (*callback)(buttons);
+} ButtonSubscriber;
+
+/**
+ * @brief The buttons held at the last sample
+ */
+static unsigned long Current;
 /**
- * Represents the array of "wasPressed" for all 27 available buttons.
+ * @brief The buttons which went down (Pressed) and up (Released) between the last two samples
  */
-bool buttonPressed[27];
+static unsigned long Pressed, Released;
+static ButtonSubscriber Subscribers[BUTTONS_MAX_SUBSCRIBERS];
+static int NumSubscribers;
 
 /**
- * @brief Initializes the buttons array.
+ * @brief Initializes the buttons masks. Buttons held at the first sample do not count as new presses.
  */
 void initButtons()
 {
-	for (int i = 0; i <= 27; i++)
-		buttonPressed[i] = false;
+	Current = buttonsRead();
+	Pressed = 0;
+	Released = 0;
 }
 
 /**
- * @brief Detects if button is a new press from most recent check by comparing previous
- *        value to current value.
+ * @brief Reads all buttons without changing the sampled state
+ *
+ * @returns Returns a mask with bit n set if the button with value n in the buttons enumeration is held
+ */
+unsigned long buttonsRead()
+{
+	unsigned long mask = 0;
+	for (int joystick = 0; joystick < 2; joystick++)
+	{
+		if (joystick == 1 && !isJoystickConnected(2))
+			break;
+		for (int i = 0; i < BUTTONS_PER_JOYSTICK; i++)
+			if (joystickGetDigital(joystick + 1, ButtonGroup[i], ButtonLocation[i]))
+				mask |= BUTTON_MASK(joystick * BUTTONS_PER_JOYSTICK + i);
+	}
+	// LCD_BTN_LEFT, LCD_BTN_CENTER, and LCD_BTN_RIGHT are bits 0 to 2, in the same order as LCD_LEFT to LCD_RIGHT
+	mask |= (unsigned long)(lcdReadButtons(uart1) & 0x7) << LCD_LEFT;
+	return mask;
+}
+
+/**
+ * @brief Samples all buttons, computes the edges since the previous sample, and runs the callbacks subscribed to them.
+ *        Call once at the start of every control loop tick.
+ */
+void buttonsSample()
+{
+	buttonsSampleMask(buttonsRead());
+}
+
+/**
+ * @brief Same as buttonsSample(), but takes the held buttons from mask instead of reading them. Used to play back
+ *        recorded inputs.
+ *
+ * @param mask
+ *        Bit n is set if the button with value n in the buttons enumeration is held
+ */
+void buttonsSampleMask(unsigned long mask)
+{
+	unsigned long previous = Current;
+	Current = mask;
+	unsigned long changed = Current ^ previous;
+	Pressed = changed & Current;
+	Released = changed & previous;
+
+	if (changed == 0)
+		return;
+	for (int i = 0; i < NumSubscribers; i++)
+	{
+		ButtonSubscriber *s = &Subscribers[i];
+		if ((s->edge == ButtonPress ? Pressed : Released) & BUTTON_MASK(s->button))
+			s->callback(s->button);
+	}
+}
+
+/**
+ * @brief Detects if button went down between the last two calls to buttonsSample().
  *
  * @param button
  *        The button to detect from the Buttons enumeration (see include/buttons.h).
@@ -47,6 +131,7 @@ void initButtons()
  * Example code:
  * @code
  *		...
+ *		buttonsSample();
  *		if(buttonIsNewPress(JOY1_8D))
  *			digitalWrite(1, !digitalRead(1));
  *		...
@@ -54,104 +139,77 @@ void initButtons()
  */
 bool buttonIsNewPress(buttons button)
 {
-	bool currentButton = false;
+	return (Pressed & BUTTON_MASK(button)) != 0;
+}
 
-	// Determine how to get the current button value (from what function) and where it
-	// is, then get it.
-	if (button < LCD_LEFT) // button is a joystick button
-	{
-		unsigned char joystick;
-		unsigned char buttonGroup;
-		unsigned char buttonLocation;
-
-		buttons newButton;
-		if (button <= 11)
-		{ // button is on joystick 1 
-			joystick = 1;
-			newButton = button;
-		}
-		else
-		{ // button is on joystick 2
-			joystick = 2;
-			// shift button down to joystick 1 buttons in order to 
-			// detect which button on joystick is queried
-			newButton = button - 12;
-		}
-
-		switch (newButton)
-		{
-			case 0:
-				buttonGroup = 5;
-				buttonLocation = JOY_DOWN;
-				break;
-			case 1:
-				buttonGroup = 5;
-				buttonLocation = JOY_UP;
-				break;
-			case 2:
-				buttonGroup = 6;
-				buttonLocation = JOY_DOWN;
-				break;
-			case 3:
-				buttonGroup = 6;
-				buttonLocation = JOY_UP;
-				break;
-			case 4:
-				buttonGroup = 7;
-				buttonLocation = JOY_UP;
-				break;
-			case 5:
-				buttonGroup = 7;
-				buttonLocation = JOY_LEFT;
-				break;
-			case 6:
-				buttonGroup = 7;
-				buttonLocation = JOY_RIGHT;
-				break;
-			case 7:
-				buttonGroup = 7;
-				buttonLocation = JOY_DOWN;
-				break;
-			case 8:
-				buttonGroup = 8;
-				buttonLocation = JOY_UP;
-				break;
-			case 9:
-				buttonGroup = 8;
-				buttonLocation = JOY_LEFT;
-				break;
-			case 10:
-				buttonGroup = 8;
-				buttonLocation = JOY_RIGHT;
-				break;
-			case 11:
-				buttonGroup = 8;
-				buttonLocation = JOY_DOWN;
-				break;
-			default:
-				break;
-		}
-		currentButton = joystickGetDigital(joystick, buttonGroup, buttonLocation);
-	}
-	else // button is on LCD
-	{
-		if (button == LCD_LEFT)
-			currentButton = (lcdReadButtons(uart1) == LCD_BTN_LEFT);
+/**
+ * @brief Detects if button went up between the last two calls to buttonsSample().
+ *
+ * @param button
+ *        The button to detect from the Buttons enumeration (see include/buttons.h).
+ */
+bool buttonIsNewRelease(buttons button)
+{
+	return (Released & BUTTON_MASK(button)) != 0;
+}
 
-		if (button == LCD_CENT)
-			currentButton = (lcdReadButtons(uart1) == LCD_BTN_CENTER);
+/**
+ * @brief Returns true if button was held at the last call to buttonsSample().
+ *
+ * @param button
+ *        The button to detect from the Buttons enumeration (see include/buttons.h).
+ */
+bool buttonIsDown(buttons button)
+{
+	return (Current & BUTTON_MASK(button)) != 0;
+}
 
-		if (button == LCD_RIGHT)
-			currentButton = (lcdReadButtons(uart1) == LCD_BTN_RIGHT);
-	}
+/**
+ * @brief Returns the mask of the buttons held at the last call to buttonsSample() (see BUTTON_MASK())
+ */
+unsigned long buttonsGetMask()
+{
+	return Current;
+}
 
-	if (!currentButton) // buttons is not currently pressed
-		buttonPressed[button] = false;
+/**
+ * @brief Returns the mask of the buttons which went down between the last two calls to buttonsSample()
+ */
+unsigned long buttonsGetPressed()
+{
+	return Pressed;
+}
 
-	if (currentButton && !buttonPressed[button]) 
-	{ // button is currently pressed and was not detected as being pressed during last check
-		buttonPressed[button] = true;
-		return true;
-	}
-	else return false; // button is not pressed or was already detected
-}
\ No newline at end of file
+/**
+ * @brief Returns the mask of the buttons which went up between the last two calls to buttonsSample()
+ */
+unsigned long buttonsGetReleased()
+{
+	return Released;
+}
+
+/**
+ * @brief Runs a callback when a button is pressed or released. The callback is run by buttonsSample(), in the task
+ *        that calls it, so it should return quickly.
+ *
+ * @param button
+ *        The button to watch from the Buttons enumeration (see include/buttons.h).
+ *
+ * @param edge
+ *        ButtonPress or ButtonRelease
+ *
+ * @param callback
+ *        Called with the button
+ *
+ * @returns Returns false if there are already BUTTONS_MAX_SUBSCRIBERS subscribers
+ */
+bool buttonSubscribe(buttons button, ButtonEdge edge, void (*callback)(buttons))
+{
+	if (callback == NULL || NumSubscribers >= BUTTONS_MAX_SUBSCRIBERS)
+		return false;
+	Subscribers[NumSubscribers].button = button;
+	Subscribers[NumSubscribers].edge = edge;
+	Subscribers[NumSubscribers].callback = callback;
+	NumSubscribers++;
+	return true;
+}
@@ -0,0 +1,309 @@
+/**
+ * @file vulcan/ghost.c
+ * @author Elliot Berman
+ * @brief Records what the driver does during teleop and plays it back through the teleop code as an autonomous.
+ *
+ * @details The teleop loops get their inputs from GhostSample() once per tick. While recording, it samples the
+ *          joysticks and buttons as usual and appends the shaped axes and the joystick button mask to a RAM buffer,
+ *          which is written to GHOST_FILE in flash by a background task when the recording stops, so the teleop
+ *          loop keeps driving during the write. While playing, it reads the next tick from the file instead of the
+ *          hardware and feeds it to the same samplers, so buttonIsNewPress() and the snapshot behave exactly as they
+ *          did for the driver. The teleop loops run every TELEOP_DELTAT milliseconds with taskDelayUntil(), so one
+ *          recorded tick is one played tick. <br>
+ *          <br>
+ *          File format (all numbers are unsigned LEB128 varints, deltas are zigzag encoded): <br>
+ *          'G' 'H' GHOST_VERSION, tick period, number of ticks, joystick buttons held before the first tick,
+ *          followed by one record per tick: a flags varint with bit n set if axis n (joystick * 4 + axis) changed
+ *          and bit 8 set if the buttons changed, then the delta of each changed axis and the XOR of the button
+ *          mask. A flags of 0 is followed by the number of further ticks in which nothing changed.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#include "main.h"
+#include "lcd/LCDFunctions.h"
+
+#include "vulcan/buttons.h"
+#include "vulcan/ghost.h"
+#include "vulcan/joystick.h"
+#include "vulcan/mechop.h"
+
+#define GHOST_NUM_AXES			(JOYSTICK_NUM * JOYSTICK_NUM_AXES)
+#define GHOST_BUTTONS_CHANGED	(1 << GHOST_NUM_AXES)
+#define GHOST_JOYSTICK_BUTTONS	(BUTTON_MASK(LCD_LEFT) - 1) // The LCD buttons run the menus and are not recorded
+#define GHOST_HEADER_SIZE		20
+#define GHOST_MAX_RECORD		(2 + 2 * GHOST_NUM_AXES + 5 + 6) // Largest tick plus a pending run of idle ticks
+
+static volatile GhostState State = GhostIdle;
+static volatile bool StopRequest;
+static unsigned char Buffer[GHOST_BUFFER_SIZE];
+static unsigned int Length, Position;
+/**
+ * @brief The inputs of the previous tick, which every record is relative to
+ */
+static signed char Axes[JOYSTICK_NUM][JOYSTICK_NUM_AXES];
+static unsigned long Buttons;
+static unsigned long InitialButtons;
+static unsigned long Ticks, TotalTicks, Idle;
+static bool Started;
+
+static void ghostPutVarint(unsigned long value)
+{
+	do
+	{
+		unsigned char byte = value & 0x7F;
+		value >>= 7;
+		Buffer[Length++] = byte | (value != 0 ? 0x80 : 0);
+	} while (value != 0);
+}
+
+static unsigned long ghostGetVarint()
+{
+	unsigned long value = 0;
+	for (int shift = 0; Position < Length && shift < 32; shift += 7)
+	{
+		unsigned char byte = Buffer[Position++];
+		value |= (unsigned long)(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+			break;
+	}
+	return value;
+}
+
+/**
+ * @brief Writes the pending run of ticks in which nothing changed
+ */
+static void ghostFlushIdle()
+{
+	if (Idle == 0)
+		return;
+	ghostPutVarint(0);
+	ghostPutVarint(Idle - 1);
+	Idle = 0;
+}
+
+/**
+ * @brief Appends one tick to the recording
+ */
+static void ghostRecord(const JoystickSnapshot *snapshot, unsigned long buttons)
+{
+	unsigned int flags = 0;
+	for (int i = 0; i < GHOST_NUM_AXES; i++)
+		if (snapshot->analog[i / JOYSTICK_NUM_AXES][i % JOYSTICK_NUM_AXES] != Axes[i / JOYSTICK_NUM_AXES][i % JOYSTICK_NUM_AXES])
+			flags |= 1 << i;
+	if (buttons != Buttons)
+		flags |= GHOST_BUTTONS_CHANGED;
+	Ticks++;
+
+	if (flags == 0)
+	{
+		Idle++;
+		return;
+	}
+	ghostFlushIdle();
+	ghostPutVarint(flags);
+	for (int i = 0; i < GHOST_NUM_AXES; i++)
+	{
+		if (!(flags & (1 << i)))
+			continue;
+		signed char *axis = &Axes[i / JOYSTICK_NUM_AXES][i % JOYSTICK_NUM_AXES];
+		int delta = snapshot->analog[i / JOYSTICK_NUM_AXES][i % JOYSTICK_NUM_AXES] - *axis;
+		ghostPutVarint(delta < 0 ? ((unsigned long)(-delta) << 1) - 1 : (unsigned long)delta << 1);
+		*axis = snapshot->analog[i / JOYSTICK_NUM_AXES][i % JOYSTICK_NUM_AXES];
+	}
+	if (flags & GHOST_BUTTONS_CHANGED)
+	{
+		ghostPutVarint(buttons ^ Buttons);
+		Buttons = buttons;
+	}
+}
+
+/**
+ * @brief Reads one tick of the recording into Axes and Buttons
+ */
+static void ghostPlay()
+{
+	Ticks++;
+	if (Idle > 0)
+	{
+		Idle--;
+		return;
+	}
+	unsigned long flags = ghostGetVarint();
+	if (flags == 0)
+	{
+		Idle = ghostGetVarint();
+		return;
+	}
+	for (int i = 0; i < GHOST_NUM_AXES; i++)
+	{
+		if (!(flags & (1 << i)))
+			continue;
+		unsigned long zigzag = ghostGetVarint();
+		int delta = (zigzag & 1) ? -(int)((zigzag + 1) >> 1) : (int)(zigzag >> 1);
+		Axes[i / JOYSTICK_NUM_AXES][i % JOYSTICK_NUM_AXES] += delta;
+	}
+	if (flags & GHOST_BUTTONS_CHANGED)
+		Buttons ^= ghostGetVarint();
+}
+
+/**
+ * @brief Writes the recording to GHOST_FILE
+ */
+static void ghostSave()
+{
+	ghostFlushIdle();
+	unsigned int body = Length;
+	// The header is built after the body, then both are written
+	ghostPutVarint(TELEOP_DELTAT);
+	ghostPutVarint(Ticks);
+	ghostPutVarint(InitialButtons);
+	unsigned char magic[3] = { 'G', 'H', GHOST_VERSION };
+
+	fdelete(GHOST_FILE);
+	FILE *file = fopen(GHOST_FILE, "w");
+	if (file == NULL)
+	{
+		lcdprint_d(Centered, 2, 1000, "Ghost not saved");
+		return;
+	}
+	fwrite(magic, 1, sizeof(magic), file);
+	fwrite(Buffer + body, 1, Length - body, file);
+	fwrite(Buffer, 1, body, file);
+	fclose(file);
+	lcdprint_d(Centered, 2, 1000, "Ghost saved");
+}
+
+/**
+ * @brief Saves the recording, then lets a new recording or playback start
+ */
+static void ghostSaveTask(void *none)
+{
+	ghostSave();
+	State = GhostIdle;
+	taskDelete(NULL);
+}
+
+/**
+ * @brief Starts recording the driver at the next teleop tick. Stops by itself after GHOST_MAX_DURATION.
+ *
+ * @returns Returns false if already recording, playing, or saving
+ */
+bool GhostRecordStart()
+{
+	if (State != GhostIdle)
+		return false;
+	Length = 0;
+	Ticks = 0;
+	Idle = 0;
+	Started = false;
+	StopRequest = false;
+	State = GhostRecording;
+	return true;
+}
+
+/**
+ * @brief Stops recording at the next teleop tick and saves the recording
+ */
+void GhostRecordStop()
+{
+	if (State == GhostRecording)
+		StopRequest = true;
+}
+
+/**
+ * @brief Loads GHOST_FILE for playback. The next calls to GhostSample() return the recorded inputs until the
+ *        recording ends, then NULL.
+ *
+ * @returns Returns false if already recording, playing, or saving, or if there is no valid recording
+ */
+bool GhostPlaybackStart()
+{
+	if (State != GhostIdle)
+		return false;
+	FILE *file = fopen(GHOST_FILE, "r");
+	if (file == NULL)
+		return false;
+	unsigned char magic[3];
+	bool valid = (fread(magic, 1, sizeof(magic), file) == sizeof(magic) && magic[0] == 'G' && magic[1] == 'H' &&
+		magic[2] == GHOST_VERSION);
+	Length = valid ? fread(Buffer, 1, GHOST_BUFFER_SIZE, file) : 0;
+	fclose(file);
+
+	Position = 0;
+	if (!valid || ghostGetVarint() != TELEOP_DELTAT)
+		return false; // Recorded with another tick period, the timing would not match
+	TotalTicks = ghostGetVarint();
+	InitialButtons = ghostGetVarint();
+	Ticks = 0;
+	Idle = 0;
+	Started = false;
+	State = GhostPlaying;
+	return true;
+}
+
+/**
+ * @brief Returns whether a recording or playback is in progress
+ */
+GhostState GhostGetState()
+{
+	return State;
+}
+
+/**
+ * @brief Samples the inputs for one teleop tick. Call once at the start of every tick instead of buttonsSample() and
+ *        JoystickSample().
+ *
+ * @returns Returns the joystick snapshot of the tick, or NULL once a playback has finished (the teleop loop should
+ *          return)
+ */
+const JoystickSnapshot *GhostSample()
+{
+	if (State == GhostPlaying)
+	{
+		if (!Started)
+		{
+			for (int i = 0; i < GHOST_NUM_AXES; i++)
+				Axes[i / JOYSTICK_NUM_AXES][i % JOYSTICK_NUM_AXES] = 0;
+			Buttons = InitialButtons;
+			// Buttons already held when the recording started are not new presses
+			buttonsSampleMask(Buttons);
+			Started = true;
+		}
+		if (Ticks >= TotalTicks || (Idle == 0 && Position >= Length))
+		{
+			State = GhostIdle;
+			return NULL;
+		}
+		ghostPlay();
+		buttonsSampleMask(Buttons);
+		return JoystickInject(Axes);
+	}
+
+	unsigned long previous = buttonsGetMask() & GHOST_JOYSTICK_BUTTONS;
+	buttonsSample();
+	const JoystickSnapshot *snapshot = JoystickSample();
+
+	if (State == GhostRecording)
+	{
+		if (!Started)
+		{
+			for (int i = 0; i < GHOST_NUM_AXES; i++)
+				Axes[i / JOYSTICK_NUM_AXES][i % JOYSTICK_NUM_AXES] = 0;
+			InitialButtons = Buttons = previous;
+			Started = true;
+		}
+		ghostRecord(snapshot, buttonsGetMask() & GHOST_JOYSTICK_BUTTONS);
+		if (StopRequest || Ticks >= GHOST_MAX_DURATION / TELEOP_DELTAT ||
+			Length + GHOST_MAX_RECORD + GHOST_HEADER_SIZE > GHOST_BUFFER_SIZE)
+		{
+			State = GhostSaving;
+			taskCreate(&ghostSaveTask, TASK_DEFAULT_STACK_SIZE, NULL, TASK_PRIORITY_LOWEST + 1);
+		}
+	}
+	return snapshot;
+}
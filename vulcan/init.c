@@ -11,17 +11,20 @@
 #include "main.h"
 
 #include "sml/SmartMotorLibrary.h"
+#include "sml/IMEManager.h"
 #include "lcd/LCDFunctions.h"
 #include "lcd/LCDManager.h"
 #include "lcd/lcdmenu.h"
 
 #include "vulcan/AutonomousHelper.h"
 #include "vulcan/buttons.h"
+#include "vulcan/joystick.h"
 #include "vulcan/CortexDefinitions.h"
 #include "vulcan/Chassis.h"
 #include "vulcan/LCDDisplays.h"
 #include "vulcan/Lift.h"
 #include "vulcan/ScoringMechanism.h"
+#include "vulcan/SkyrisePlan.h"
 
 
 /**
@@ -41,8 +44,8 @@ void initializeIO()
  *
  * @note GLOBAL VARIABLES DECLARED IN LCDDisplays.h!!!
  */
-char *titles[NUMTITLES] = { "No auton", "Blue Sky", "Blue Cube", "Red Sky", "Red Cube", "P. skills" };
-void(*exec[NUMTITLES])() = { RunNoAutonomous, RunBlueSky, RunBlueCube, RunRedSky, RunRedCube, RunPSkills };
+char *titles[NUMTITLES] = { "No auton", "Blue Sky", "Blue Cube", "Red Sky", "Red Cube", "P. skills", "Ghost", "Script" };
+void(*exec[NUMTITLES])() = { RunNoAutonomous, RunBlueSky, RunBlueCube, RunRedSky, RunRedCube, RunPSkills, RunGhost, RunScript };
 LCDMenu main_menu;
 
 /**
@@ -54,7 +57,7 @@ void initialize()
 	lcdInitialize();
 	lcdprint(Centered, 1, "Booting Vulcan");
 	lcdprint(Left, 2, "IMEs... "); // IMES must be first, followed by MotorManager. Chassis and Lift are not order dependent
-	imeInitializeAll();
+	IMEManagerInitialize(I2C_NUM_IMES);
 	delay(100);
 	lcdprint(Left, 2, "MotorManager... ");
 	InitializeMotorManager();
@@ -64,63 +67,24 @@ void initialize()
 	delay(100);
 	lcdprint(Left, 2, "Lift... ");
 	LiftInitialize();
+	SkyrisePlanInitialize();
+	JoystickInitialize();
 	delay(200);
 	lcdprint(Left, 2, "LCD Display...");
 	//DisplayText o = { &getRobotState, Left };
 	//addCycleText(o, 1);
-	lcdprintf(Centered, 1, "E:%1.1fV M:%1.1fV", (double)analogRead(ANA_POWEREXP)/70.0, (double)powerLevelMain()/1000.0); /// @todo double check power expander reading is correct
+	lcdprintf(Centered, 1, "E:%1.1qV M:%1.1qV", analogRead(ANA_POWEREXP), 70, powerLevelMain(), 1000); /// @todo double check power expander reading is correct
 	lcdprint_d(Left, 2, 500, "....complete...."); lcdprint_d(Left, 1, 500, "Competition mode");
 	lcdprint_d(Left, 1, 500, "Competition mode");
-#ifdef AUTO_DEBUG
+	// The selection is made from the menu task, so initialize() returns right away
 	main_menu = lcdmenuCreate(NUMTITLES, titles, exec);
-	bool quit = false;
-	lcdprint(Centered, 1, "Select auton");
-	lcdmenuDisplay(&main_menu);
-	while (!quit)
-	{
-		if (buttonIsNewPress(LCD_LEFT))
-			lcdmenuShift(&main_menu, LCD_SHIFT_LEFT);
-		else if (buttonIsNewPress(LCD_CENT))
-		{
-			lcdmenuDecide(&main_menu);
-			quit = true;
-			continue;
-		}
-		else if (buttonIsNewPress(LCD_RIGHT))
-			lcdmenuShift(&main_menu, LCD_SHIFT_RIGHT);
-		//delay and allow for other tasks to take place
-		delay(100);
-	}
-	lcdprint(Centered, 1, "Selected");
-	//print the selected autonomous
-	lcdprintf(Centered, 2, "%s", main_menu.titles[main_menu.execute]);
-	delay(750);
+	MenuInitialize();
+#ifdef AUTO_DEBUG
+	MenuOpenAutonSelect();
 #endif
 	if (!isEnabled() && isOnline())
 	{
 		lcdprint_d(Left, 1, 500, "Competition mode");
-		main_menu = lcdmenuCreate(NUMTITLES, titles, exec);
-		bool quit = false;
-		lcdprint(Centered, 1, "Select auton");
-		lcdmenuDisplay(&main_menu);
-		while (!quit && !isEnabled() && isOnline())
-		{
-			if (buttonIsNewPress(LCD_LEFT))
-				lcdmenuShift(&main_menu, LCD_SHIFT_LEFT);
-			else if (buttonIsNewPress(LCD_CENT))
-			{
-				lcdmenuDecide(&main_menu);
-				quit = true;
-				continue;
-			}
-			else if (buttonIsNewPress(LCD_RIGHT))
-				lcdmenuShift(&main_menu, LCD_SHIFT_RIGHT);
-			//delay and allow for other tasks to take place
-			delay(100);
-		}
-		lcdprint(Centered, 1, "Selected");
-		//print the selected autonomous
-		lcdprintf(Centered, 2, "%s", main_menu.titles[main_menu.execute]);
-		delay(750);
+		MenuOpenAutonSelect();
 	}
 }
@@ -0,0 +1,134 @@
+/**
+ * @file vulcan/joystick.c
+ * @author Elliot Berman
+ * @brief Reads the joystick axes once per control loop tick and shapes them through lookup tables.
+ *
+ * @details Every axis has a 256 entry table, indexed by the raw value + 128, which holds the shaped value: zero inside
+ *          the deadband, then rescaled so it starts from zero at the edge of the deadband, blended towards a cubic
+ *          curve by the expo, and negated if inverted. The tables are built when an axis is configured, so shaping
+ *          costs one table lookup per axis per tick no matter how the drive feel is tuned. By default the tables
+ *          pass the raw value through unchanged, and the drive mixers keep their all-axes THRESHOLD.
+ *
+ * @htmlonly
+ * @copyright Copyright (c) 2014-2015 Olympic Steel Eagles. All rights reserved. <br>
+ * Portions of this file may contain elements from the PROS API. <br>
+ * See ReadMe.md (Main Page) for additional notice.
+ * @endhtmlonly
+ ********************************************************************************/
+
+#include "main.h"
+#include "vulcan/joystick.h"
+
+static signed char Curves[JOYSTICK_NUM][JOYSTICK_NUM_AXES][256];
+static JoystickSnapshot Snapshot;
+
+/**
+ * @brief Configures all axes with the default deadband and expo, not inverted
+ */
+void JoystickInitialize()
+{
+	for (int joystick = 1; joystick <= JOYSTICK_NUM; joystick++)
+		for (int axis = 1; axis <= JOYSTICK_NUM_AXES; axis++)
+			JoystickConfigureAxis(joystick, axis, JOYSTICK_DEFAULT_DEADBAND, JOYSTICK_DEFAULT_EXPO, false);
+}
+
+/**
+ * @brief Builds the lookup table of an axis
+ *
+ * @param joystick
+ *			The joystick [1,2]
+ *
+ * @param axis
+ *			The axis [1,4]
+ *
+ * @param deadband
+ *			Raw values with a magnitude below this are 0 [0,126]
+ *
+ * @param expo
+ *			0 is linear, 100 is cubic, anything in between blends the two (softer near the center) [0,100]
+ *
+ * @param inverted
+ *			True to negate the axis
+ */
+void JoystickConfigureAxis(unsigned char joystick, unsigned char axis, unsigned char deadband, unsigned char expo,
+		bool inverted)
+{
+	if (joystick < 1 || joystick > JOYSTICK_NUM || axis < 1 || axis > JOYSTICK_NUM_AXES) return;
+	if (deadband > 126) deadband = 126;
+	if (expo > 100) expo = 100;
+
+	signed char *curve = Curves[joystick - 1][axis - 1];
+	for (int i = 0; i < 256; i++)
+	{
+		int raw = i - 128, magnitude = abs(raw);
+		if (magnitude > 127) magnitude = 127;
+		int out = 0;
+		if (magnitude >= deadband && magnitude > 0)
+		{
+			// Rescale [deadband,127] onto [1,127]
+			long linear = 1 + (long)(magnitude - deadband) * 126 / (127 - deadband);
+			long cubic = linear * linear * linear / (127L * 127L);
+			out = (int)((linear * (100 - expo) + cubic * expo + 50) / 100);
+			if (out < 1) out = 1;
+		}
+		if (raw < 0) out = -out;
+		curve[i] = (signed char)(inverted ? -out : out);
+	}
+}
+
+/**
+ * @brief Reads every axis of both joysticks once and shapes it. Call once at the start of every control loop tick,
+ *        then use the snapshot or JoystickGetAnalog() for the rest of the tick.
+ *
+ * @returns Returns the snapshot, which is valid until the next call
+ */
+const JoystickSnapshot *JoystickSample()
+{
+	for (int joystick = 0; joystick < JOYSTICK_NUM; joystick++)
+	{
+		bool connected = (joystick == 0 || isJoystickConnected(joystick + 1));
+		for (int axis = 0; axis < JOYSTICK_NUM_AXES; axis++)
+		{
+			int raw = connected ? joystickGetAnalog(joystick + 1, axis + 1) : 0;
+			if (raw < -128) raw = -128;
+			if (raw > 127) raw = 127;
+			Snapshot.raw[joystick][axis] = raw;
+			Snapshot.analog[joystick][axis] = Curves[joystick][axis][raw + 128];
+		}
+	}
+	Snapshot.time = millis();
+	return &Snapshot;
+}
+
+/**
+ * @brief Replaces the snapshot with already shaped axes instead of reading the joysticks. Used to play back
+ *        recorded inputs.
+ *
+ * @param analog
+ *			analog[joystick - 1][axis - 1] is the shaped axis
+ *
+ * @returns Returns the snapshot, which is valid until the next call
+ */
+const JoystickSnapshot *JoystickInject(signed char analog[JOYSTICK_NUM][JOYSTICK_NUM_AXES])
+{
+	for (int joystick = 0; joystick < JOYSTICK_NUM; joystick++)
+		for (int axis = 0; axis < JOYSTICK_NUM_AXES; axis++)
+			Snapshot.raw[joystick][axis] = Snapshot.analog[joystick][axis] = analog[joystick][axis];
+	Snapshot.time = millis();
+	return &Snapshot;
+}
+
+/**
+ * @brief Returns a shaped axis from the last snapshot taken by JoystickSample()
+ *
+ * @param joystick
+ *			The joystick [1,2]
+ *
+ * @param axis
+ *			The axis [1,4]
+ */
+int JoystickGetAnalog(unsigned char joystick, unsigned char axis)
+{
+	if (joystick < 1 || joystick > JOYSTICK_NUM || axis < 1 || axis > JOYSTICK_NUM_AXES) return 0;
+	return Snapshot.analog[joystick - 1][axis - 1];
+}
@@ -127,10 +127,81 @@ int aHypo(double h1, double h2)
     return (int)(roundf((h1 + h2) / 2));
 }
 
+/**
+ * @brief cos and sin (scaled by 2^22) of the angles at which thetaSector() moves up one sector, i.e. where
+ *        roundf(theta * 1000) reaches 393 * k, for k = 1 to 7
+ */
+static const long SectorBoundaryCos[7] = { 3875351, 2965519, 1603530, -2951, -1608983, -2969690, -3877605 };
+static const long SectorBoundarySin[7] = { 1604319, 2966123, 3875678, 4194303, 3873417, 2961946, 1598864 };
+
+/**
+ * @brief Integer-only equivalent of thetaSector(getJoyTheta(x, y)).
+ *
+ * @details The point is mirrored into the upper half plane and compared against each sector boundary with a cross
+ *          product, so no division, arctangent, or floating point is needed.
+ *
+ * @param x
+ *        X value for a joystick [-127,127].
+ * @param y
+ *        Y value for a joystick [-127,127].
+ *
+ * @return Sector number, the same as thetaSector() would return
+ */
+int joySector(int x, int y)
+{
+	if (x == 0 && y == 0)
+		return 3; // getJoyTheta() returns pi/2
+	// getJoyTheta() returns -pi for the negative x axis
+	bool negative = (y < 0 || (y == 0 && x < 0));
+	long ay = abs(y);
+	int sector = 0;
+	while (sector < 7 && ay * SectorBoundaryCos[sector] - x * SectorBoundarySin[sector] >= 0)
+		sector++;
+	return negative ? -sector : sector;
+}
+
+/**
+ * @brief Integer square root of a, rounded down
+ */
+static unsigned long isqrt(unsigned long a)
+{
+	unsigned long root = 0, bit = 1UL << 30;
+	while (bit > a)
+		bit >>= 2;
+	while (bit != 0)
+	{
+		if (a >= root + bit)
+		{
+			a -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+			root >>= 1;
+		bit >>= 2;
+	}
+	return root;
+}
+
+/**
+ * @brief Integer-only equivalent of aHypo(cHypo(x1, y1), cHypo(x2, y2)).
+ *
+ * @details Each hypotenuse is computed with 8 fractional bits, which rounds the same way as the floating point
+ *          version except when the average is within 1/256 of a half.
+ *
+ * @return The average of the two hypotenuses, rounded
+ */
+int joyHypoAverage(int x1, int y1, int x2, int y2)
+{
+	unsigned long h1 = isqrt(((unsigned long)(x1 * x1 + y1 * y1)) << 16);
+	unsigned long h2 = isqrt(((unsigned long)(x2 * x2 + y2 * y2)) << 16);
+	return (int)((h1 + h2 + 256) >> 9);
+}
+
 
 #define MOTOROPTION false // used for the function below
 /**
-* @brief Controls robot wheels.
+* @brief Controls robot wheels. The inputs are shaped by JoystickSample(), so anything inside the deadband is
+*        already 0.
 * 
 * @param r1
 *        Right joystick, channel 1 input
@@ -143,8 +214,8 @@ int aHypo(double h1, double h2)
 */
 void JoystickControl(int r1, int r2, int l3, int l4)
 {
-    int left = thetaSector( getJoyTheta(l4, l3) ), //left joystick
-        right = thetaSector( getJoyTheta(r1, r2) ); // right joystick
+    int left = joySector(l4, l3), //left joystick
+        right = joySector(r1, r2); // right joystick
 
 	//lcdprintf(Left, 2, "L:%dR:%d", left, right);
 
@@ -190,7 +261,7 @@ void JoystickControl(int r1, int r2, int l3, int l4)
 	else if ((left  == 2 || left  == 1) &&
 		(right == 2 || right == 1))
 	{
-		int h = aHypo(cHypo(l4, l3), cHypo(r1, r2));
+		int h = joyHypoAverage(l4, l3, r1, r2);
 		ChassisSetMecanum(M_PI_4,
 			h,
 			0, MOTOROPTION);
@@ -202,7 +273,7 @@ void JoystickControl(int r1, int r2, int l3, int l4)
 		(right == 5 || right == 6))
 	{
 		ChassisSetMecanum(-M_PI_4,
-			aHypo(cHypo(l4, l3), cHypo(r1, r2)),
+			joyHypoAverage(l4, l3, r1, r2),
 			0, MOTOROPTION);
 #if MECHOP_DEBUG
 		lcdprint(Centered, 1, "northwest");
@@ -215,7 +286,7 @@ void JoystickControl(int r1, int r2, int l3, int l4)
 		(right == -2 || right == -1))
 	{
 		ChassisSetMecanum(-3.0 * M_PI_4,
-			aHypo(cHypo(l4, l3), cHypo(r1, r2)),
+			joyHypoAverage(l4, l3, r1, r2),
 			0, MOTOROPTION);
 #if MECHOP_DEBUG
 		lcdprint(Centered, 1, "southeast");
@@ -225,7 +296,7 @@ void JoystickControl(int r1, int r2, int l3, int l4)
 		(right == -5 || right == -6))
 	{
 		ChassisSetMecanum(3.0 * M_PI_4,
-			aHypo(cHypo(l4, l3), cHypo(r1, r2)),
+			joyHypoAverage(l4, l3, r1, r2),
 			0, MOTOROPTION);
 #if MECHOP_DEBUG
 		lcdprint(Centered, 1, "southwest");
@@ -262,4 +333,29 @@ void JoystickControl(int r1, int r2, int l3, int l4)
 		ChassisSet(l3, r2, MOTOROPTION);
 		//lcdprint(Centered, 1, "stopping");
 	}
-}
\ No newline at end of file
+}
+/**
+* @brief Continuous holonomic drive: the left joystick translates in any direction and the right joystick's x axis
+*        rotates, all mixed at once by ChassisSetHolonomic(). Takes the same inputs as JoystickControl() so either
+*        can drive.
+*
+* @param r1
+*        Right joystick, channel 1 input (rotation, right turns clockwise)
+* @param r2
+*        Right joystick, channel 2 input (unused)
+* @param l3
+*        Left joystick, channel 3 input (forward)
+* @param l4
+*        Left joystick, channel 4 input (strafe)
+*/
+void HolonomicControl(int r1, int r2, int l3, int l4)
+{
+	if (abs(l3) < THRESHOLD && abs(l4) < THRESHOLD && abs(r1) < THRESHOLD && abs(r2) < THRESHOLD)
+	{
+		ChassisSet(0, 0, MOTOROPTION);
+		return;
+	}
+
+	// Turning right drives the left side forward, which is a negative rotation for ChassisSetHolonomic()
+	ChassisSetHolonomic(l3, l4, -r1, MOTOROPTION);
+}
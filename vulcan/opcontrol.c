@@ -12,196 +12,134 @@
 #include "main.h"
 #include "sml/SmartMotorLibrary.h"
 #include "lcd/LCDFunctions.h"
+#include "lcd/lcdtree.h"
 
 #include "vulcan/buttons.h"
+#include "vulcan/ghost.h"
+#include "vulcan/joystick.h"
 #include "vulcan/mechop.h"
 #include "vulcan/CortexDefinitions.h"
 #include "vulcan/Chassis.h"
 #include "vulcan/Lift.h"
 #include "vulcan/ScoringMechanism.h"
+#include "vulcan/SkyrisePlan.h"
 #include "vulcan/LCDDisplays.h"
 
 #define NEEDLE_DEPLOY_DURATION			2000
 
 bool pidEnabled = false;
 
+static const int GroundHeight = 0;
+static const int SamPresetHeights[] = { 35, 20, 90 };
 
-/**
-* @brief Control schema for Josh's driving preferences
-*/
-void JoshControl()
-{
-	long startNeedleDeploy = -NEEDLE_DEPLOY_DURATION;
-	bool mode = true; // true is standard "forward is forward" control and false is "forward is backward" control for use when building skyrise
-	while (true)
-	{
-		// ---------- VARIOUS SWITCHES ---------- //
+// Lift presets go in priority order, only the first one pressed in a tick is used
+static const DriverBinding JoshBindings[] = {
 #ifdef AUTO_DEBUG
-		if (buttonIsNewPress(JOY1_7L)) autonomous();
+	{ .button = JOY1_7L, .action = DriverAutonomous },
 #endif
-		if (buttonIsNewPress(JOY1_7D)) mode = !mode;
-
-		// ---------- CHASSIS CONTROL ---------- //
-		// Tank Control
-		//ChassisSet((mode ? -joystickGetAnalog(1, 2) : joystickGetAnalog(1, 3)), (mode ? -joystickGetAnalog(1, 3) : joystickGetAnalog(1, 2)), false); 
-
-		// Mecanum Control
-		JoystickControl(mode ? joystickGetAnalog(1, 1) : -joystickGetAnalog(1, 4), joystickGetAnalog(1, 2),
-			joystickGetAnalog(1, 3), mode ? joystickGetAnalog(1, 4) : -joystickGetAnalog(1, 1));
-
-		// ------------ LIFT CONTROL ------------ //
-		if (buttonIsNewPress(JOY1_8U))
-		{ // High Post
-			LiftSetHeight(85);
-			pidEnabled = true;
-		}
-		else if (buttonIsNewPress(JOY1_8R))
-		{ // Medium Post 
-			LiftSetHeight(13);
-			pidEnabled = true;
-		}
-		else if (buttonIsNewPress(JOY1_8L))
-		{ // Low Post
-			LiftSetHeight(20);
-			pidEnabled = true;
-		}
-		else if (buttonIsNewPress(JOY1_7U))
-		{ // Single cube
-			LiftSetHeight(8);
-			pidEnabled = true;
-		}
-		else if (buttonIsNewPress(JOY1_8D))
-		{ // Ground
-			LiftSetHeight(0);
-			pidEnabled = true;
-		}
-
-		if (joystickGetDigital(1, 6, JOY_UP))
-		{
-			LiftSet(127, false);
-			pidEnabled = false;
-		}
-		else if (joystickGetDigital(1, 6, JOY_DOWN))
-		{
-			LiftSet(-100, false);
-			pidEnabled = false;
-		}
-		else if (!pidEnabled)
-			LiftSet(0, false);
+	{ .button = JOY1_7D, .action = DriverReverse },
+	{ .button = JOY1_8U, .action = DriverLiftHeight, .height = &LiftPresetHeights[LiftHighPost] },
+	{ .button = JOY1_8R, .action = DriverLiftHeight, .height = &LiftPresetHeights[LiftMediumPost] },
+	{ .button = JOY1_8L, .action = DriverLiftHeight, .height = &LiftPresetHeights[LiftLowPost] },
+	{ .button = JOY1_7U, .action = DriverLiftHeight, .height = &LiftPresetHeights[LiftSingleCube] },
+	{ .button = JOY1_8D, .action = DriverLiftHeight, .height = &GroundHeight },
+	{ .button = JOY1_7R, .action = DriverSwitchProfile, .profile = DriverSam },
+};
+
+static const DriverBinding SamBindings[] = {
+#ifdef AUTO_DEBUG
+	{ .button = JOY1_7L, .action = DriverAutonomous },
+#endif
+	{ .button = JOY1_8U, .action = DriverLiftHeight, .height = &GroundHeight },
+	{ .button = JOY1_8R, .action = DriverLiftHeight, .height = &SamPresetHeights[0] },
+	{ .button = JOY1_8L, .action = DriverLiftHeight, .height = &SamPresetHeights[1] },
+	{ .button = JOY1_8D, .action = DriverLiftHeight, .height = &SamPresetHeights[2] },
+	{ .button = JOY1_7D, .action = DriverSwitchProfile, .profile = DriverJosh },
+};
 
-		// --------- SCORE MECH CONTROL --------- //
-		if (joystickGetDigital(1, 5, JOY_DOWN))
-			startNeedleDeploy = millis();
+/**
+ * @brief The driver profiles. Josh reverses the strafe and turn axes when building skyrises, and his claw lifts the
+ *        lift above each skyrise built so far along the stacking plan.
+ */
+const DriverProfile DriverProfiles[NUM_DRIVER_PROFILES] = {
+	[DriverJosh] = { .title = "J Vulcan " VERSION, .subtitle = "teleop", .drive = &JoystickControl,
+		.axes = { 1, 2, 3, 4 }, .reversedAxes = { -4, 2, 3, -1 },
+		.bindings = JoshBindings, .numBindings = sizeof(JoshBindings) / sizeof(DriverBinding),
+		.clawLiftTrajectories = SkyriseCarryTrajectories, .numClawLiftTrajectories = SKYRISE_LEVELS,
+		.clawLiftDefault = 13, .countSkyrises = true },
+	[DriverSam] = { .title = "S Vulcan " VERSION, .subtitle = "opcontrol", .drive = &JoystickControl,
+		.axes = { 1, 2, 3, 4 }, .reversedAxes = { 1, 2, 3, 4 },
+		.bindings = SamBindings, .numBindings = sizeof(SamBindings) / sizeof(DriverBinding),
+		.clawLiftTrajectories = NULL, .numClawLiftTrajectories = 0, .clawLiftDefault = 15, .countSkyrises = false },
+};
 
-		if (millis() - startNeedleDeploy > NEEDLE_DEPLOY_DURATION)
-			ScoringMechNeedleSet(true);
-		else
-			ScoringMechNeedleSet(false);
+/**
+ * @brief Returns joystick 1 channel axis from the snapshot, negated if axis is negative
+ */
+static int TeleopAxis(const JoystickSnapshot *joy, signed char axis)
+{
+	return axis < 0 ? -joy->analog[0][-axis - 1] : joy->analog[0][axis - 1];
+}
 
-		if (buttonIsNewPress(JOY1_5U))
+/**
+ * @brief Runs teleop with the controls of a driver profile. Switching profiles only changes which profile is
+ *        interpreted, so drivers can swap any number of times.
+ *
+ * @param profile
+ *        The profile to start with
+ */
+void TeleopRun(const DriverProfile *profile)
+{
+	long startNeedleDeploy = -NEEDLE_DEPLOY_DURATION;
+	unsigned long wakeTime = millis();
+	bool reversed = false; // false is standard "forward is forward" control and true is "forward is backward" control for use when building skyrise
+	while (true)
+	{
+		const JoystickSnapshot *joy = GhostSample();
+		if (joy == NULL)
+			return; // A ghost driver playback has finished
+
+		// ---------- BUTTON BINDINGS ---------- //
+		const DriverProfile *next = profile;
+		bool liftPreset = false;
+		for (int i = 0; i < profile->numBindings; i++)
 		{
-
-			if (LiftGetQuadEncLeft() < 5 && !ScoringMechClawGet())
+			const DriverBinding *binding = &profile->bindings[i];
+			if (!buttonIsNewPress(binding->button))
+				continue;
+			switch (binding->action)
 			{
-				switch (skyriseBuilt)
-				{
-				case 0:
-					LiftSetHeight(15);
-					break;
-				case 1:
-					LiftSetHeight(18);
-					break;
-				case 2:
-					LiftSetHeight(33);
+				case DriverLiftHeight:
+					if (!liftPreset)
+					{
+						LiftSetHeight(*binding->height);
+						pidEnabled = true;
+						liftPreset = true;
+					}
 					break;
-				case 3:
-					LiftSetHeight(48);
+				case DriverReverse:
+					reversed = !reversed;
 					break;
-				case 4:
-					LiftSetHeight(67);
+				case DriverSwitchProfile:
+					next = &DriverProfiles[binding->profile];
 					break;
-				case 5:
-					LiftSetHeight(83);
+				case DriverAutonomous:
+					autonomous();
 					break;
-				case 6:
-					LiftSetHeight(150);
-					break;
-				default:
-					LiftSetHeight(13);
-				}
-				skyriseBuilt++;
-				pidEnabled = true;
 			}
-
-			ScoringMechClawSwitch();
 		}
 
-		// ----------- DRIVER SWITCH ----------- //
-		if (buttonIsNewPress(JOY1_7R))
-			SamControl();
-
-		// ------------ LCD PRINTERS ----------- //
-		lcdprintf(Centered, 1, "J Vulcan %s", VERSION);
-		lcdprint(Centered, 2, "teleop");
-		//lcdprintf(Centered, 2, "cl:%04d r:%04d", ChassisGetIMELeft(), ChassisGetIMERight());
-		//lcdprintf(Centered, 2, "el:%02d r:%02d", LiftGetQuadEncLeft(), LiftGetQuadEncRight());
-		//lcdprintf(Centered, 2, "il:%04d r: %04d", ChassisGetIRRight(), ChassisGetIRLeft());
-		//lcdprintf(Centered, 2, "l:%d r:%d", ChassisHasIRLineLeft(Grey), ChassisHasIRLineRight(Grey));
-		/*int ir = ChassisGetIRRight();
-		lcdprintf(Centered, 1, "g:%d  v:%04d", (ir < 600) ? 1 : 0, ir);
-		lcdprintf(Centered, 2, "r:%d  b:%d", (ir < 450) ? 1 : 0, (ir < 300) ? 1 : 0);*/
-
-		delay(15);
-	}
-}
-
-/**
-* @brief Control schema for Sam's driving preferences
-*/
-void SamControl()
-{
-	long startNeedleDeploy = -NEEDLE_DEPLOY_DURATION;
-	while (true)
-	{
-#ifdef AUTO_DEBUG
-		if (buttonIsNewPress(JOY1_7L)) autonomous();
-#endif
-
 		// ---------- CHASSIS CONTROL ---------- //
-		// Tank Control
-		//ChassisSet((mode ? -joystickGetAnalog(1, 2) : joystickGetAnalog(1, 3)), (mode ? -joystickGetAnalog(1, 3) : joystickGetAnalog(1, 2)), false); 
-
-		// Mecanum Control
-		JoystickControl(joystickGetAnalog(1, 1), joystickGetAnalog(1, 2), joystickGetAnalog(1, 3), joystickGetAnalog(1, 4));
+		const signed char *axes = reversed ? profile->reversedAxes : profile->axes;
+		profile->drive(TeleopAxis(joy, axes[0]), TeleopAxis(joy, axes[1]), TeleopAxis(joy, axes[2]), TeleopAxis(joy, axes[3]));
 
 		// ------------ LIFT CONTROL ------------ //
-		if (buttonIsNewPress(JOY1_8U))
-		{ // Ground
-			LiftSetHeight(0);
-			pidEnabled = true;
-		}
-		else if (buttonIsNewPress(JOY1_8R))
-		{ // Medium Post 
-			LiftSetHeight(35);
-			pidEnabled = true;
-		}
-		else if (buttonIsNewPress(JOY1_8L))
-		{ // Low Post
-			LiftSetHeight(20);
-			pidEnabled = true;
-		}
-		else if (buttonIsNewPress(JOY1_8D))
-		{ // High post
-			LiftSetHeight(90);
-			pidEnabled = true;
-		}
-
-		if (joystickGetDigital(1, 6, JOY_UP))
+		if (buttonIsDown(JOY1_6U))
 		{
 			LiftSet(127, false);
 			pidEnabled = false;
 		}
-		else if (joystickGetDigital(1, 6, JOY_DOWN))
+		else if (buttonIsDown(JOY1_6D))
 		{
 			LiftSet(-100, false);
 			pidEnabled = false;
@@ -210,7 +148,7 @@ void SamControl()
 			LiftSet(0, false);
 
 		// --------- SCORE MECH CONTROL --------- //
-		if (joystickGetDigital(1, 5, JOY_DOWN))
+		if (buttonIsDown(JOY1_5D))
 			startNeedleDeploy = millis();
 
 		if (millis() - startNeedleDeploy > NEEDLE_DEPLOY_DURATION)
@@ -223,39 +161,67 @@ void SamControl()
 			// If lift is on ground and we're grabbing a skyrise, automatically go up above the autoloader
 			if (LiftGetQuadEncLeft() < 5 && !ScoringMechClawGet())
 			{
-				LiftSetHeight(15);
+				if (skyriseBuilt >= 0 && skyriseBuilt < profile->numClawLiftTrajectories)
+					LiftFollowTrajectory(&profile->clawLiftTrajectories[skyriseBuilt]);
+				else
+					LiftSetHeight(profile->clawLiftDefault);
+				if (profile->countSkyrises)
+					skyriseBuilt++;
 				pidEnabled = true;
 			}
 
 			ScoringMechClawSwitch();
 		}
 
-		// ----------- DRIVER SWITCH ----------- //
-		if (buttonIsNewPress(JOY1_7D))
-			JoshControl();
-
 		// ------------ LCD PRINTERS ----------- //
-		lcdprintf(Centered, 1, "S Vulcan %s", VERSION);
-		lcdprint(Centered, 2, "opcontrol");
-		//lcdprintf(Centered, 1, "cl:%04d r:%04d", ChassisGetIMELeft(), ChassisGetIMERight());
+		if (!lcdtreeIsOpen())
+		{
+			lcdprint(Centered, 1, (char *)profile->title);
+			lcdprint(Centered, 2, (char *)profile->subtitle);
+		}
+		//lcdprintf(Centered, 2, "cl:%04d r:%04d", ChassisGetIMELeft(), ChassisGetIMERight());
 		//lcdprintf(Centered, 2, "el:%02d r:%02d", LiftGetQuadEncLeft(), LiftGetQuadEncRight());
 		//lcdprintf(Centered, 2, "il:%04d r: %04d", ChassisGetIRRight(), ChassisGetIRLeft());
-		//lcdprintf(Centered, 2, "l:%d/%04d r:%d/%04d", ChassisHasIRLineLeft(Grey), ChassisGetIRLeft(), ChassisHasIRLineRight(Grey), ChassisGetIRLeft());
+		//lcdprintf(Centered, 2, "l:%d r:%d", ChassisHasIRLineLeft(Grey), ChassisHasIRLineRight(Grey));
 		/*int ir = ChassisGetIRRight();
 		lcdprintf(Centered, 1, "g:%d  v:%04d", (ir < 600) ? 1 : 0, ir);
 		lcdprintf(Centered, 2, "r:%d  b:%d", (ir < 450) ? 1 : 0, (ir < 300) ? 1 : 0);*/
 
-		delay(15);
+		// ----------- DRIVER SWITCH ----------- //
+		if (next != profile)
+		{
+			profile = next;
+			reversed = false;
+		}
+
+		taskDelayUntil(&wakeTime, TELEOP_DELTAT);
 	}
 }
 
+/**
+* @brief Control schema for Josh's driving preferences
+*/
+void JoshControl()
+{
+	TeleopRun(&DriverProfiles[DriverJosh]);
+}
+
+/**
+* @brief Control schema for Sam's driving preferences
+*/
+void SamControl()
+{
+	TeleopRun(&DriverProfiles[DriverSam]);
+}
+
 /**
  * @brief Sets motors in motion based on user input (from controls).
  */
 void operatorControl()
 {
+	initButtons();
 	if (digitalRead(DIG_DRIVER_JUMPER)) // Jumper out: Josh is driver
 		JoshControl();
 	else
 		SamControl();
-}
\ No newline at end of file
+}